@@ -0,0 +1,35 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# Checks that requests with a bad "timeout" are turned away without
+# holding a place in the server's queue. Start moses or moses2 with
+# --server --server-max-queue 2 (or any small limit), then run
+#   test_bad_timeout.py [url]
+
+import sys
+
+try:
+    import xmlrpclib
+except ImportError:
+    import xmlrpc.client as xmlrpclib
+
+url = sys.argv[1] if len(sys.argv) > 1 else "http://localhost:8080/RPC2"
+proxy = xmlrpclib.ServerProxy(url)
+
+text = u"il a souhaité que la présidence trace à nice le chemin pour l' avenir ."
+
+# many more than any small server-max-queue
+for i in range(100):
+    try:
+        proxy.translate({"text": text, "timeout": "soon"})
+    except xmlrpclib.Fault as e:
+        if "busy" in e.faultString:
+            print("FAIL: request %d refused as busy: %s" % (i, e.faultString))
+            sys.exit(1)
+    else:
+        print("FAIL: non-numeric timeout was accepted")
+        sys.exit(1)
+
+result = proxy.translate({"text": text, "timeout": 30})
+print(result['text'])
+print("OK")
@@ -89,6 +89,55 @@ void ArrayBhiksha::FinishedLoading(const Config &config) {
   *(head_write++) = config.pointer_bhiksha_bits;
 }
 
+const uint8_t kEliasFanoBhikshaVersion = 0;
+
+void EliasFanoBhiksha::UpdateConfigFromBinary(const BinaryFormat &file, uint64_t offset, Config &/*config*/) {
+  uint8_t version;
+  file.ReadForConfig(&version, 1, offset);
+  if (version != kEliasFanoBhikshaVersion) UTIL_THROW(FormatLoadException, "This file has Elias-Fano pointer compression version " << (unsigned) version << " but the code expects version " << (unsigned)kEliasFanoBhikshaVersion);
+}
+
+namespace {
+
+// Low bits per pointer: floor(log2((max_next + 1) / max_offset)).
+uint8_t EliasFanoLowBits(uint64_t max_offset, uint64_t max_next) {
+  uint8_t bits = 0;
+  while (bits < 56 && ((max_next + 1) >> (bits + 1)) >= max_offset) ++bits;
+  return bits;
+}
+
+uint64_t EliasFanoSamples(uint64_t max_offset, uint64_t select_sample) {
+  return (max_offset + select_sample - 1) / select_sample;
+}
+
+// One set bit per pointer plus one clear bit per value of the high bits.
+uint64_t EliasFanoHighWords(uint64_t max_offset, uint64_t max_next) {
+  return (max_offset + (max_next >> EliasFanoLowBits(max_offset, max_next)) + 1 + 63) / 64;
+}
+
+} // namespace
+
+uint64_t EliasFanoBhiksha::Size(uint64_t max_offset, uint64_t max_next, const Config &/*config*/) {
+  return sizeof(uint64_t) * (1 /* header */ + EliasFanoSamples(max_offset, kSelectSample) + EliasFanoHighWords(max_offset, max_next))
+    + (max_offset * EliasFanoLowBits(max_offset, max_next) + 7) / 8
+    + sizeof(uint64_t) /* so that ReadInt57 etc don't go segfault */
+    + 7 /* 8-byte alignment */;
+}
+
+EliasFanoBhiksha::EliasFanoBhiksha(void *base, uint64_t max_offset, uint64_t max_next, const Config &/*config*/)
+  : low_(util::BitsMask::ByBits(EliasFanoLowBits(max_offset, max_next))),
+    samples_(reinterpret_cast<uint64_t*>(AlignTo8(base)) + 1 /* 8-byte header */),
+    high_(samples_ + EliasFanoSamples(max_offset, kSelectSample)),
+    low_begin_(reinterpret_cast<uint8_t*>(high_ + EliasFanoHighWords(max_offset, max_next))),
+    max_offset_(max_offset),
+    written_(0),
+    original_base_(base) {}
+
+void EliasFanoBhiksha::FinishedLoading(const Config &/*config*/) {
+  if (written_ != max_offset_) UTIL_THROW(util::Exception, "Did not get all the pointers that were expected.");
+  *reinterpret_cast<uint8_t*>(original_base_) = kEliasFanoBhikshaVersion;
+}
+
 } // namespace trie
 } // namespace ngram
 } // namespace lm
@@ -115,6 +115,78 @@ class ArrayBhiksha {
     void *original_base_;
 };
 
+/* Elias-Fano coding of the next pointers, which are non-decreasing.  The low
+ * bits of each pointer are packed in an array and the high bits are written
+ * in unary to a bit vector with one set bit per pointer, so a pointer costs
+ * about 2 + log2(max_next / max_offset) bits however the pointers are
+ * distributed.  Nothing is stored inline.  Selecting a pointer's set bit
+ * starts from the recorded position of every kSelectSample-th set bit.
+ */
+class EliasFanoBhiksha {
+  public:
+    static const ModelType kModelTypeAdd = kEliasFanoAdd;
+
+    static void UpdateConfigFromBinary(const BinaryFormat &file, uint64_t offset, Config &config);
+
+    static uint64_t Size(uint64_t max_offset, uint64_t max_next, const Config &config);
+
+    static uint8_t InlineBits(uint64_t /*max_offset*/, uint64_t /*max_next*/, const Config &/*config*/) { return 0; }
+
+    EliasFanoBhiksha(void *base, uint64_t max_offset, uint64_t max_next, const Config &config);
+
+    void ReadNext(const void * /*base*/, uint64_t /*bit_offset*/, uint64_t index, uint8_t /*total_bits*/, NodeRange &out) const {
+      // Skip from the sampled set bit to the one for index.
+      uint64_t position = samples_[index / kSelectSample];
+      const uint64_t *word = high_ + (position >> 6);
+      uint64_t bits = *word & (~0ULL << (position & 63));
+      for (uint64_t skip = index % kSelectSample; ; bits = *++word) {
+        unsigned int count = util::PopCount64(bits);
+        if (skip < count) {
+          for (; skip; --skip) bits &= bits - 1;
+          break;
+        }
+        skip -= count;
+      }
+      out.begin = ((static_cast<uint64_t>(word - high_) * 64 + util::LowestBit64(bits) - index) << low_.bits) | ReadLow(index);
+      // The next set bit is for index + 1.
+      bits &= bits - 1;
+      while (!bits) bits = *++word;
+      out.end = ((static_cast<uint64_t>(word - high_) * 64 + util::LowestBit64(bits) - index - 1) << low_.bits) | ReadLow(index + 1);
+      assert(out.end >= out.begin);
+    }
+
+    void WriteNext(void * /*base*/, uint64_t /*bit_offset*/, uint64_t index, uint64_t value) {
+      assert(index == written_);
+      uint64_t position = (value >> low_.bits) + index;
+      high_[position >> 6] |= 1ULL << (position & 63);
+      if (!(index % kSelectSample)) samples_[index / kSelectSample] = position;
+      util::WriteInt57(low_begin_, index * low_.bits, low_.bits, value & low_.mask);
+      ++written_;
+    }
+
+    void FinishedLoading(const Config &config);
+
+    uint8_t InlineBits() const { return 0; }
+
+  private:
+    static const uint64_t kSelectSample = 256;
+
+    uint64_t ReadLow(uint64_t index) const {
+      return util::ReadInt57(low_begin_, index * low_.bits, low_.bits, low_.mask);
+    }
+
+    const util::BitsMask low_;
+
+    uint64_t *const samples_;
+    uint64_t *const high_;
+    uint8_t *const low_begin_;
+
+    const uint64_t max_offset_;
+    uint64_t written_;
+
+    void *original_base_;
+};
+
 } // namespace trie
 } // namespace ngram
 } // namespace lm
@@ -15,7 +15,7 @@
 namespace lm {
 namespace ngram {
 
-const char *kModelNames[6] = {"probing hash tables", "probing hash tables with rest costs", "trie", "trie with quantization", "trie with array-compressed pointers", "trie with quantization and array-compressed pointers"};
+const char *kModelNames[8] = {"probing hash tables", "probing hash tables with rest costs", "trie", "trie with quantization", "trie with array-compressed pointers", "trie with quantization and array-compressed pointers", "trie with Elias-Fano pointers", "trie with quantization and Elias-Fano pointers"};
 
 namespace {
 const char kMagicBeforeVersion[] = "mmap lm http://kheafield.com/code format version";
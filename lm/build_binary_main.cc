@@ -23,7 +23,7 @@ namespace ngram {
 namespace {
 
 void Usage(const char *name, const char *default_mem) {
-  std::cerr << "Usage: " << name << " [-u log10_unknown_probability] [-s] [-i] [-w mmap|after] [-p probing_multiplier] [-T trie_temporary] [-S trie_building_mem] [-q bits] [-b bits] [-a bits] [type] input.arpa [output.mmap]\n\n"
+  std::cerr << "Usage: " << name << " [-u log10_unknown_probability] [-s] [-i] [-w mmap|after] [-p probing_multiplier] [-T trie_temporary] [-S trie_building_mem] [-j threads] [-q bits] [-b bits] [-a bits] [-e] [type] input.arpa [output.mmap]\n\n"
 "-u sets the log10 probability for <unk> if the ARPA file does not have one.\n"
 "   Default is -100.  The ARPA file will always take precedence.\n"
 "-s allows models to be built even if they do not have <s> and </s>.\n"
@@ -34,7 +34,9 @@ void Usage(const char *name, const char *default_mem) {
 "-r \"order1.arpa order2 order3 order4\" adds lower-order rest costs from these\n"
 "   model files.  order1.arpa must be an ARPA file.  All others may be ARPA or\n"
 "   the same data structure as being built.  All files must have the same\n"
-"   vocabulary.  For probing, the unigrams must be in the same order.\n\n"
+"   vocabulary.  For probing, the unigrams must be in the same order.\n"
+"-j sets the number of threads used to parse the ARPA file and, for trie, to\n"
+"   sort.  The output does not depend on it.  Default is 1.\n\n"
 "type is either probing or trie.  Default is probing.\n\n"
 "probing uses a probing hash table.  It is the fastest but uses the most memory.\n"
 "-p sets the space multiplier and must be >1.0.  The default is 1.5.\n\n"
@@ -50,7 +52,9 @@ void Usage(const char *name, const char *default_mem) {
 "-b sets backoff quantization bits.  Requires -q and defaults to that value.\n"
 "-a compresses pointers using an array of offsets.  The parameter is the\n"
 "   maximum number of bits encoded by the array.  Memory is minimized subject\n"
-"   to the maximum, so pick 255 to minimize memory.\n\n"
+"   to the maximum, so pick 255 to minimize memory.\n"
+"-e compresses pointers with Elias-Fano coding instead of -a.  This usually\n"
+"   takes less memory.\n\n"
 "-h print this help message.\n\n"
 "Get a memory estimate by passing an ARPA file without an output file name.\n";
   exit(1);
@@ -108,11 +112,11 @@ int main(int argc, char *argv[]) {
     Usage(argv[0], default_mem);
 
   try {
-    bool quantize = false, set_backoff_bits = false, bhiksha = false, set_write_method = false, rest = false;
+    bool quantize = false, set_backoff_bits = false, bhiksha = false, elias_fano = false, set_write_method = false, rest = false;
     lm::ngram::Config config;
     config.building_memory = util::ParseSize(default_mem);
     int opt;
-    while ((opt = getopt(argc, argv, "q:b:a:u:p:t:T:m:S:w:sir:h")) != -1) {
+    while ((opt = getopt(argc, argv, "q:b:a:u:p:t:T:m:S:j:w:eisr:h")) != -1) {
       switch(opt) {
         case 'q':
           config.prob_bits = ParseBitCount(optarg);
@@ -127,6 +131,9 @@ int main(int argc, char *argv[]) {
           config.pointer_bhiksha_bits = ParseBitCount(optarg);
           bhiksha = true;
           break;
+        case 'e':
+          elias_fano = true;
+          break;
         case 'u':
           config.unknown_missing_logprob = ParseFloat(optarg);
           break;
@@ -144,6 +151,9 @@ int main(int argc, char *argv[]) {
         case 'S':
           config.building_memory = std::min(static_cast<uint64_t>(std::numeric_limits<std::size_t>::max()), util::ParseSize(optarg));
           break;
+        case 'j':
+          config.building_threads = std::max<unsigned long>(ParseUInt(optarg), 1);
+          break;
         case 'w':
           set_write_method = true;
           if (!strcmp(optarg, "mmap")) {
@@ -207,15 +217,23 @@ int main(int argc, char *argv[]) {
         return 1;
       }
       if (!set_write_method) config.write_method = Config::WRITE_MMAP;
+      if (bhiksha && elias_fano) {
+        std::cerr << "Pick one of -a and -e." << std::endl;
+        return 1;
+      }
       if (quantize) {
         if (bhiksha) {
           QuantArrayTrieModel(from_file, config);
+        } else if (elias_fano) {
+          QuantEliasFanoTrieModel(from_file, config);
         } else {
           QuantTrieModel(from_file, config);
         }
       } else {
         if (bhiksha) {
           ArrayTrieModel(from_file, config);
+        } else if (elias_fano) {
+          EliasFanoTrieModel(from_file, config);
         } else {
           TrieModel(from_file, config);
         }
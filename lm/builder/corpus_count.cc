@@ -9,12 +9,16 @@
 #include "util/file.hh"
 #include "util/file_piece.hh"
 #include "util/murmur_hash.hh"
+#include "util/pcqueue.hh"
 #include "util/probing_hash_table.hh"
 #include "util/scoped.hh"
 #include "util/stream/chain.hh"
 #include "util/stream/timer.hh"
 #include "util/tokenize_piece.hh"
 
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
 #include <functional>
 
 #include <stdint.h>
@@ -65,17 +69,20 @@ const float kProbingMultiplier = 1.5;
 
 typedef util::ProbingHashTable<DedupeEntry, DedupeHash, DedupeEquals> Dedupe;
 
-class Writer {
+/* Blocks is either util::stream::Link or LocalBlocks: something with a
+ * current block that ++ passes on and Poison ends.
+ */
+template <class Blocks> class Writer {
   public:
-    Writer(std::size_t order, const util::stream::ChainPosition &position, void *dedupe_mem, std::size_t dedupe_mem_size)
-      : block_(position), gram_(block_->Get(), order),
+    Writer(std::size_t order, Blocks &blocks, std::size_t block_size, void *dedupe_mem, std::size_t dedupe_mem_size, bool add_specials)
+      : block_(blocks), gram_(block_->Get(), order),
         dedupe_invalid_(order, std::numeric_limits<WordIndex>::max()),
         dedupe_(dedupe_mem, dedupe_mem_size, &dedupe_invalid_[0], DedupeHash(order), DedupeEquals(order)),
         buffer_(new WordIndex[order - 1]),
-        block_size_(position.GetChain().BlockSize()) {
+        block_size_(block_size) {
       dedupe_.Clear();
-      assert(Dedupe::Size(position.GetChain().BlockSize() / position.GetChain().EntrySize(), kProbingMultiplier) == dedupe_mem_size);
-      if (order == 1) {
+      assert(Dedupe::Size(block_size / NGram<BuildingPayload>::TotalSize(order), kProbingMultiplier) == dedupe_mem_size);
+      if (order == 1 && add_specials) {
         // Add special words.  AdjustCounts is responsible if order != 1.
         AddUnigramWord(kUNK);
         AddUnigramWord(kBOS);
@@ -134,7 +141,7 @@ class Writer {
       }
     }
 
-    util::stream::Link block_;
+    Blocks &block_;
 
     NGram<BuildingPayload> gram_;
 
@@ -149,6 +156,125 @@ class Writer {
     const std::size_t block_size_;
 };
 
+/* With several counting threads, each writes to private blocks that
+ * CorpusCount::Run copies into the chain.  A NULL block on full means one
+ * counting thread has finished.
+ */
+class LocalBlocks {
+  public:
+    LocalBlocks(util::PCQueue<util::stream::Block> &free, util::PCQueue<util::stream::Block> &full)
+      : free_(free), full_(full) {
+      free_.Consume(current_);
+    }
+
+    util::stream::Block *operator->() { return &current_; }
+
+    LocalBlocks &operator++() {
+      full_.Produce(current_);
+      free_.Consume(current_);
+      return *this;
+    }
+
+    void Poison() {
+      free_.Produce(current_);
+      full_.Produce(util::stream::Block());
+    }
+
+  private:
+    util::stream::Block current_;
+    util::PCQueue<util::stream::Block> &free_, &full_;
+};
+
+// Sentences as vocabulary ids, each ending with </s>.  NULL means stop.
+typedef std::vector<WordIndex> Batch;
+
+// Words per batch handed to a counting thread.
+const std::size_t kBatchWords = 1 << 16;
+
+class CountThread {
+  public:
+    CountThread(util::PCQueue<Batch*> &batches, util::PCQueue<util::stream::Block> &free, util::PCQueue<util::stream::Block> &full, std::size_t order, std::size_t block_size, void *dedupe_mem, std::size_t dedupe_mem_size, WordIndex end_sentence, bool add_specials)
+      : batches_(batches), free_(free), full_(full), order_(order), block_size_(block_size),
+        dedupe_mem_(dedupe_mem), dedupe_mem_size_(dedupe_mem_size), end_sentence_(end_sentence), add_specials_(add_specials) {}
+
+    void operator()() {
+      try {
+        LocalBlocks blocks(free_, full_);
+        Writer<LocalBlocks> writer(order_, blocks, block_size_, dedupe_mem_, dedupe_mem_size_, add_specials_);
+        Batch *batch;
+        while (batches_.Consume(batch)) {
+          writer.StartSentence();
+          for (Batch::const_iterator i = batch->begin(); i != batch->end(); ++i) {
+            writer.Append(*i);
+            if (*i == end_sentence_) writer.StartSentence();
+          }
+          delete batch;
+        }
+      } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        abort();
+      }
+    }
+
+  private:
+    util::PCQueue<Batch*> &batches_;
+    util::PCQueue<util::stream::Block> &free_, &full_;
+    std::size_t order_, block_size_;
+    void *dedupe_mem_;
+    std::size_t dedupe_mem_size_;
+    WordIndex end_sentence_;
+    bool add_specials_;
+};
+
+// Moves blocks filled by the counting threads into the chain.  The chain is
+// poisoned by CorpusCount::Run once the counts are known.
+class CopyThread {
+  public:
+    CopyThread(util::stream::Link &link, util::PCQueue<util::stream::Block> &free, util::PCQueue<util::stream::Block> &full, std::size_t threads)
+      : link_(link), free_(free), full_(full), threads_(threads) {}
+
+    void operator()() {
+      util::stream::Block block;
+      for (std::size_t running = threads_; running;) {
+        if (!full_.Consume(block)) {
+          --running;
+          continue;
+        }
+        memcpy(link_->Get(), block.Get(), block.ValidSize());
+        link_->SetValidSize(block.ValidSize());
+        ++link_;
+        free_.Produce(block);
+      }
+    }
+
+  private:
+    util::stream::Link &link_;
+    util::PCQueue<util::stream::Block> &free_, &full_;
+    std::size_t threads_;
+};
+
+// Stops the counting and copying threads when CorpusCount::Run is done
+// reading, including by exception.
+class StopThreads {
+  public:
+    StopThreads(util::PCQueue<Batch*> &batches, std::size_t threads, boost::thread_group &counters, boost::thread &copier)
+      : batches_(batches), threads_(threads), counters_(counters), copier_(copier) {}
+
+    ~StopThreads() {
+      for (std::size_t i = 0; i < threads_; ++i) {
+        batches_.Produce(NULL);
+      }
+      counters_.join_all();
+      copier_.join();
+    }
+
+  private:
+    util::PCQueue<Batch*> &batches_;
+    std::size_t threads_;
+    boost::thread_group &counters_;
+    boost::thread &copier_;
+};
+
 } // namespace
 
 float CorpusCount::DedupeMultiplier(std::size_t order) {
@@ -159,11 +285,18 @@ std::size_t CorpusCount::VocabUsage(std::size_t vocab_estimate) {
   return ngram::GrowableVocab<ngram::WriteUniqueWords>::MemUsage(vocab_estimate);
 }
 
-CorpusCount::CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol)
+float CorpusCount::CountingMultiplier(std::size_t order, std::size_t threads) {
+  if (threads <= 1) return DedupeMultiplier(order);
+  // Each thread has a hash table and two private blocks in circulation.
+  return static_cast<float>(threads) * (DedupeMultiplier(order) + 2.0);
+}
+
+CorpusCount::CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol, std::size_t threads)
   : from_(from), vocab_write_(vocab_write), token_count_(token_count), type_count_(type_count),
     prune_words_(prune_words), prune_vocab_filename_(prune_vocab_filename),
     dedupe_mem_size_(Dedupe::Size(entries_per_block, kProbingMultiplier)),
-    dedupe_mem_(util::MallocOrThrow(dedupe_mem_size_)),
+    threads_(std::max<std::size_t>(threads, 1)),
+    dedupe_mem_(util::MallocOrThrow(dedupe_mem_size_ * threads_)),
     disallowed_symbol_action_(disallowed_symbol) {
 }
 
@@ -187,26 +320,74 @@ void CorpusCount::Run(const util::stream::ChainPosition &position) {
   token_count_ = 0;
   type_count_ = 0;
   const WordIndex end_sentence = vocab.FindOrInsert("</s>");
-  Writer writer(NGram<BuildingPayload>::OrderFromSize(position.GetChain().EntrySize()), position, dedupe_mem_.get(), dedupe_mem_size_);
+  const std::size_t order = NGram<BuildingPayload>::OrderFromSize(position.GetChain().EntrySize());
+  const std::size_t block_size = position.GetChain().BlockSize();
   uint64_t count = 0;
   bool delimiters[256];
   util::BoolCharacter::Build("\0\t\n\r ", delimiters);
-  try {
-    while(true) {
-      StringPiece line(from_.ReadLine());
-      writer.StartSentence();
-      for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w) {
-        WordIndex word = vocab.FindOrInsert(*w);
-        if (word <= 2) {
-          ComplainDisallowed(*w, disallowed_symbol_action_);
-          continue;
+  util::stream::Link link(position);
+  // The chain ends when the writer is destroyed, so it lives until the counts are set.
+  util::scoped_ptr<Writer<util::stream::Link> > writer;
+  if (threads_ == 1) {
+    writer.reset(new Writer<util::stream::Link>(order, link, block_size, dedupe_mem_.get(), dedupe_mem_size_, true));
+    try {
+      while(true) {
+        StringPiece line(from_.ReadLine());
+        writer->StartSentence();
+        for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w) {
+          WordIndex word = vocab.FindOrInsert(*w);
+          if (word <= 2) {
+            ComplainDisallowed(*w, disallowed_symbol_action_);
+            continue;
+          }
+          writer->Append(word);
+          ++count;
         }
-        writer.Append(word);
-        ++count;
+        writer->Append(end_sentence);
       }
-      writer.Append(end_sentence);
+    } catch (const util::EndOfFileException &e) {}
+  } else {
+    /* This thread assigns vocabulary ids, so they come out in the same order
+     * as with one thread.  Counting threads dedupe n-grams in their own
+     * blocks; the sort's CombineCounts adds up n-grams that appear in
+     * several blocks, as it already does for one thread.
+     */
+    util::PCQueue<Batch*> batches(2 * threads_);
+    util::PCQueue<util::stream::Block> free(2 * threads_), full(3 * threads_);
+    util::scoped_malloc local_mem(util::MallocOrThrow(2 * threads_ * block_size));
+    for (std::size_t i = 0; i < 2 * threads_; ++i) {
+      free.Produce(util::stream::Block(static_cast<uint8_t*>(local_mem.get()) + i * block_size, block_size));
+    }
+    boost::thread copier(CopyThread(link, free, full, threads_));
+    boost::thread_group counters;
+    for (std::size_t i = 0; i < threads_; ++i) {
+      counters.create_thread(CountThread(batches, free, full, order, block_size, static_cast<uint8_t*>(dedupe_mem_.get()) + i * dedupe_mem_size_, dedupe_mem_size_, end_sentence, i == 0));
     }
-  } catch (const util::EndOfFileException &e) {}
+    StopThreads stop(batches, threads_, counters, copier);
+    util::scoped_ptr<Batch> batch(new Batch());
+    batch->reserve(kBatchWords);
+    try {
+      while(true) {
+        StringPiece line(from_.ReadLine());
+        for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w) {
+          WordIndex word = vocab.FindOrInsert(*w);
+          if (word <= 2) {
+            ComplainDisallowed(*w, disallowed_symbol_action_);
+            continue;
+          }
+          batch->push_back(word);
+          ++count;
+        }
+        batch->push_back(end_sentence);
+        if (batch->size() >= kBatchWords) {
+          batches.Produce(batch.release());
+          batch.reset(new Batch());
+          batch->reserve(kBatchWords);
+        }
+      }
+    } catch (const util::EndOfFileException &e) {}
+    if (!batch->empty()) batches.Produce(batch.release());
+  }
   token_count_ = count;
   type_count_ = vocab.Size();
 
@@ -233,6 +414,8 @@ void CorpusCount::Run(const util::stream::ChainPosition &position) {
       abort();
     }
   }
+
+  if (!writer.get()) link.Poison();
 }
 
 } // namespace builder
@@ -28,9 +28,15 @@ class CorpusCount {
     // How much memory vocabulary will use based on estimated size of the vocab.
     static std::size_t VocabUsage(std::size_t vocab_estimate);
 
+    // Memory outside the chain, in blocks, used to count with this many
+    // threads.  For one thread this is DedupeMultiplier(order).
+    static float CountingMultiplier(std::size_t order, std::size_t threads);
+
     // token_count: out.
     // type_count aka vocabulary size.  Initialize to an estimate.  It is set to the exact value.
-    CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol);
+    // threads: number of threads deduplicating n-grams.  The input is still
+    // read and assigned vocabulary ids by one thread.
+    CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol, std::size_t threads = 1);
 
     void Run(const util::stream::ChainPosition &position);
 
@@ -40,9 +46,11 @@ class CorpusCount {
     uint64_t &token_count_;
     WordIndex &type_count_;
     std::vector<bool>& prune_words_;
-    const std::string& prune_vocab_filename_;
+    const std::string prune_vocab_filename_;
 
     std::size_t dedupe_mem_size_;
+    std::size_t threads_;
+    // One hash table per thread.
     util::scoped_malloc dedupe_mem_;
 
     WarningAction disallowed_symbol_action_;
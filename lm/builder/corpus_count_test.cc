@@ -13,6 +13,9 @@
 #define BOOST_TEST_MODULE CorpusCountTest
 #include <boost/test/unit_test.hpp>
 
+#include <map>
+#include <string>
+
 namespace lm { namespace builder { namespace {
 
 #define Check(str, cnt) { \
@@ -76,4 +79,52 @@ BOOST_AUTO_TEST_CASE(Short) {
   BOOST_CHECK_EQUAL(sizeof(v) / sizeof(const char*), type_count);
 }
 
+// Threads dedupe into their own blocks, so duplicates across blocks are only
+// combined by the sort.  Add them up here instead.
+BOOST_AUTO_TEST_CASE(Threaded) {
+  util::scoped_fd input_file(util::MakeTemp("corpus_count_test_temp"));
+  const char input[] = "looking on a little more loin\non a little more loin\non foo little more loin\nbar\n\n";
+  util::WriteOrThrow(input_file.get(), input, sizeof(input) - 1);
+  util::FilePiece input_piece(input_file.release(), "temp file");
+
+  util::stream::ChainConfig config;
+  config.entry_size = NGram<BuildingPayload>::TotalSize(3);
+  config.total_memory = config.entry_size * 20;
+  config.block_count = 2;
+
+  util::scoped_fd vocab(util::MakeTemp("corpus_count_test_vocab"));
+
+  util::stream::Chain chain(config);
+  uint64_t token_count;
+  WordIndex type_count = 10;
+  std::vector<bool> prune_words;
+  CorpusCount counter(input_piece, vocab.get(), token_count, type_count, prune_words, "", chain.BlockSize() / chain.EntrySize(), SILENT, 3);
+  chain >> boost::ref(counter);
+  NGramStream<BuildingPayload> stream(chain.Add());
+  chain >> util::stream::kRecycle;
+
+  const char *v[] = {"<unk>", "<s>", "</s>", "looking", "on", "a", "little", "more", "loin", "foo", "bar"};
+
+  std::map<std::string, uint64_t> counts;
+  for (; stream; ++stream) {
+    std::string gram;
+    for (const WordIndex *w = stream->begin(); w != stream->end(); ++w) {
+      if (w != stream->begin()) gram += ' ';
+      gram += v[*w];
+    }
+    counts[gram] += stream->Value().count;
+  }
+  BOOST_CHECK_EQUAL(15U, counts.size());
+  BOOST_CHECK_EQUAL(1U, counts["<s> <s> looking"]);
+  BOOST_CHECK_EQUAL(2U, counts["on a little"]);
+  BOOST_CHECK_EQUAL(3U, counts["little more loin"]);
+  BOOST_CHECK_EQUAL(3U, counts["more loin </s>"]);
+  BOOST_CHECK_EQUAL(2U, counts["<s> <s> on"]);
+  BOOST_CHECK_EQUAL(1U, counts["<s> on foo"]);
+  BOOST_CHECK_EQUAL(1U, counts["<s> bar </s>"]);
+  BOOST_CHECK_EQUAL(1U, counts["<s> <s> </s>"]);
+  BOOST_CHECK_EQUAL(17U, token_count);
+  BOOST_CHECK_EQUAL(sizeof(v) / sizeof(const char*), type_count);
+}
+
 }}} // namespaces
@@ -2,6 +2,7 @@
 #include "lm/builder/pipeline.hh"
 #include "lm/common/size_option.hh"
 #include "lm/lm_exception.hh"
+#include "lm/model_type.hh"
 #include "util/file.hh"
 #include "util/file_piece.hh"
 #include "util/usage.hh"
@@ -64,6 +65,22 @@ lm::builder::Discount ParseDiscountFallback(const std::vector<std::string> &para
   return ret;
 }
 
+// Pick the binary data structure the way build_binary does.
+lm::ngram::ModelType ParseBinaryType(const std::string &type, bool quantize, bool bhiksha, bool elias_fano) {
+  if (type == "probing") {
+    UTIL_THROW_IF(quantize || bhiksha || elias_fano, util::Exception, "Quantization and pointer compression are only implemented in the trie data structure.");
+    return lm::ngram::PROBING;
+  }
+  UTIL_THROW_IF(type != "trie", util::Exception, "Unknown binary type " << type << ".  Use probing or trie.");
+  UTIL_THROW_IF(bhiksha && elias_fano, util::Exception, "Pick one of --binary_pointer_bits and --binary_elias_fano.");
+  return static_cast<lm::ngram::ModelType>(lm::ngram::TRIE + (quantize ? lm::ngram::kQuantAdd : 0) + (bhiksha ? lm::ngram::kArrayAdd : 0) + (elias_fano ? lm::ngram::kEliasFanoAdd : 0));
+}
+
+uint8_t CheckBitCount(int bits) {
+  UTIL_THROW_IF(bits < 0 || bits > 25, util::Exception, "Bit counts are limited to 25, not " << bits << ".");
+  return bits;
+}
+
 } // namespace
 
 int main(int argc, char *argv[]) {
@@ -72,14 +89,16 @@ int main(int argc, char *argv[]) {
     po::options_description options("Language model building options");
     lm::builder::PipelineConfig pipeline;
 
-    std::string text, intermediate, arpa;
+    std::string text, intermediate, arpa, binary, binary_type;
+    int binary_prob_bits, binary_backoff_bits, binary_pointer_bits;
+    lm::ngram::Config binary_config;
     std::vector<std::string> pruning;
     std::vector<std::string> discount_fallback;
     std::vector<std::string> discount_fallback_default;
     discount_fallback_default.push_back("0.5");
     discount_fallback_default.push_back("1");
     discount_fallback_default.push_back("1.5");
-    bool verbose_header;
+    bool verbose_header, binary_elias_fano;
 
     options.add_options()
       ("help,h", po::bool_switch(), "Show this help message")
@@ -95,12 +114,20 @@ int main(int argc, char *argv[]) {
       ("minimum_block", lm::SizeOption(pipeline.minimum_block, "8K"), "Minimum block size to allow")
       ("sort_block", lm::SizeOption(pipeline.sort.buffer_size, "64M"), "Size of IO operations for sort (determines arity)")
       ("block_count", po::value<std::size_t>(&pipeline.block_count)->default_value(2), "Block count (per order)")
+      ("threads", po::value<std::size_t>(&pipeline.threads)->default_value(1), "Threads to count n-grams with.  Each extra thread needs memory for its own hash table and two blocks.")
       ("vocab_estimate", po::value<lm::WordIndex>(&pipeline.vocab_estimate)->default_value(1000000), "Assume this vocabulary size for purposes of calculating memory in step 1 (corpus count) and pre-sizing the hash table")
       ("vocab_pad", po::value<uint64_t>(&pipeline.vocab_size_for_unk)->default_value(0), "If the vocabulary is smaller than this value, pad with <unk> to reach this size. Requires --interpolate_unigrams")
       ("verbose_header", po::bool_switch(&verbose_header), "Add a verbose header to the ARPA file that includes information such as token count, smoothing type, etc.")
       ("text", po::value<std::string>(&text), "Read text from a file instead of stdin")
       ("arpa", po::value<std::string>(&arpa), "Write ARPA to a file instead of stdout")
       ("intermediate", po::value<std::string>(&intermediate), "Write ngrams to intermediate files.  Turns off ARPA output (which can be reactivated by --arpa file).  Forces --renumber on.")
+      ("binary", po::value<std::string>(&binary), "Build a KenLM binary file without writing a temporary ARPA file for build_binary.  Turns off ARPA output (which can be reactivated by --arpa file).  The ARPA text is still formatted and parsed, after the rest of the pipeline and after the -S memory is released, and needs as much time and memory as build_binary would.")
+      ("binary_type", po::value<std::string>(&binary_type)->default_value("probing"), "Data structure for --binary: probing or trie")
+      ("binary_prob_bits", po::value<int>(&binary_prob_bits), "Quantize trie probabilities to this many bits, like build_binary -q")
+      ("binary_backoff_bits", po::value<int>(&binary_backoff_bits), "Quantize trie backoffs to this many bits, like build_binary -b.  Defaults to --binary_prob_bits")
+      ("binary_pointer_bits", po::value<int>(&binary_pointer_bits), "Compress trie pointers, removing up to this many bits, like build_binary -a")
+      ("binary_elias_fano", po::bool_switch(&binary_elias_fano), "Compress trie pointers with Elias-Fano coding, like build_binary -e")
+      ("binary_memory", lm::SizeOption(binary_config.building_memory, "1G"), "Memory for sorting while building a trie with --binary")
       ("renumber", po::bool_switch(&pipeline.renumber_vocabulary), "Rrenumber the vocabulary identifiers so that they are monotone with the hash of each string.  This is consistent with the ordering used by the trie data structure.")
       ("collapse_values", po::bool_switch(&pipeline.output_q), "Collapse probability and backoff into a single value, q that yields the same sentence-level probabilities.  See http://kheafield.com/professional/edinburgh/rest_paper.pdf for more details, including a proof.")
       ("prune", po::value<std::vector<std::string> >(&pruning)->multitoken(), "Prune n-grams with count less than or equal to the given threshold.  Specify one value for each order i.e. 0 0 1 to prune singleton trigrams and above.  The sequence of values must be non-decreasing and the last value applies to any remaining orders. Default is to not prune, which is equivalent to --prune 0.")
@@ -202,10 +229,29 @@ int main(int argc, char *argv[]) {
       if (writing_intermediate) {
         pipeline.renumber_vocabulary = true;
       }
+      bool writing_binary = vm.count("binary");
       lm::builder::Output output(writing_intermediate ? intermediate : pipeline.sort.temp_prefix, writing_intermediate, pipeline.output_q);
-      if (!writing_intermediate || vm.count("arpa")) {
+      if ((!writing_intermediate && !writing_binary) || vm.count("arpa")) {
         output.Add(new lm::builder::PrintHook(out.release(), verbose_header));
       }
+      if (writing_binary) {
+        bool quantize = vm.count("binary_prob_bits");
+        bool bhiksha = vm.count("binary_pointer_bits");
+        lm::ngram::ModelType model_type = ParseBinaryType(binary_type, quantize, bhiksha, binary_elias_fano);
+        if (quantize) {
+          binary_config.prob_bits = CheckBitCount(binary_prob_bits);
+          binary_config.backoff_bits = vm.count("binary_backoff_bits") ? CheckBitCount(binary_backoff_bits) : binary_config.prob_bits;
+        } else {
+          UTIL_THROW_IF(vm.count("binary_backoff_bits"), util::Exception, "You specified --binary_backoff_bits but not --binary_prob_bits");
+        }
+        if (bhiksha) binary_config.pointer_bhiksha_bits = CheckBitCount(binary_pointer_bits);
+        binary_config.temporary_directory_prefix = pipeline.sort.temp_prefix;
+        binary_config.write_method = model_type == lm::ngram::PROBING ? lm::ngram::Config::WRITE_AFTER : lm::ngram::Config::WRITE_MMAP;
+        binary_config.arpa_complain = lm::ngram::Config::NONE;
+        // lmplz has its own progress bars.
+        binary_config.show_progress = false;
+        output.Add(new lm::builder::BinaryHook(binary, model_type, binary_config));
+      }
       lm::builder::Pipeline(pipeline, in.release(), output);
     } catch (const util::MallocException &e) {
       std::cerr << e.what() << std::endl;
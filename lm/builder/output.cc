@@ -1,14 +1,141 @@
 #include "lm/builder/output.hh"
 
+#include "lm/builder/payload.hh"
 #include "lm/common/model_buffer.hh"
+#include "lm/common/ngram.hh"
 #include "lm/common/print.hh"
+#include "lm/model.hh"
 #include "util/file_stream.hh"
 #include "util/stream/multi_stream.hh"
 
+#include <boost/thread/thread.hpp>
+
 #include <iostream>
 
+#include <unistd.h>
+
 namespace lm { namespace builder {
 
+namespace {
+
+void BuildModel(int fd, ngram::ModelType model_type, const ngram::Config &config) {
+  const char *name = "lmplz output";
+  switch (model_type) {
+    case ngram::PROBING:
+      {
+        ngram::ProbingModel model(fd, name, config);
+      }
+      break;
+    case ngram::REST_PROBING:
+      {
+        ngram::RestProbingModel model(fd, name, config);
+      }
+      break;
+    case ngram::TRIE:
+      {
+        ngram::TrieModel model(fd, name, config);
+      }
+      break;
+    case ngram::QUANT_TRIE:
+      {
+        ngram::QuantTrieModel model(fd, name, config);
+      }
+      break;
+    case ngram::ARRAY_TRIE:
+      {
+        ngram::ArrayTrieModel model(fd, name, config);
+      }
+      break;
+    case ngram::QUANT_ARRAY_TRIE:
+      {
+        ngram::QuantArrayTrieModel model(fd, name, config);
+      }
+      break;
+    case ngram::EF_TRIE:
+      {
+        ngram::EliasFanoTrieModel model(fd, name, config);
+      }
+      break;
+    case ngram::QUANT_EF_TRIE:
+      {
+        ngram::QuantEliasFanoTrieModel model(fd, name, config);
+      }
+      break;
+    default:
+      close(fd);
+      UTIL_THROW(util::Exception, "Unknown binary model type " << model_type);
+  }
+}
+
+// Loads the model from the read end of the pipe.
+class BuildThread {
+  public:
+    // Takes ownership of fd.  drain is another descriptor for the pipe.
+    BuildThread(int fd, int drain, ngram::ModelType model_type, const ngram::Config &config, std::string &error)
+      : fd_(fd), drain_(drain), model_type_(model_type), config_(config), error_(error) {}
+
+    void operator()() {
+      try {
+        BuildModel(fd_, model_type_, config_);
+      } catch (const std::exception &e) {
+        error_ = e.what();
+      }
+      // If loading stopped early, keep reading so the writer doesn't block.
+      char buffer[4096];
+      try {
+        while (util::ReadOrEOF(drain_, buffer, sizeof(buffer))) {}
+      } catch (const util::Exception &e) {}
+    }
+
+  private:
+    int fd_, drain_;
+    ngram::ModelType model_type_;
+    const ngram::Config &config_;
+    std::string &error_;
+};
+
+class PrintBinary {
+  public:
+    // Does not take ownership of vocab_fd.
+    PrintBinary(int vocab_fd, const std::vector<uint64_t> &counts, const std::string &file, ngram::ModelType model_type, const ngram::Config &config)
+      : vocab_fd_(vocab_fd), counts_(counts), file_(file), model_type_(model_type), config_(config) {}
+
+    void Run(const util::stream::ChainPositions &positions) {
+      int fds[2];
+      UTIL_THROW_IF(pipe(fds), util::ErrnoException, "Could not create a pipe to build " << file_);
+      util::scoped_fd read_end(fds[0]), write_end(fds[1]);
+      util::scoped_fd drain(util::DupOrThrow(read_end.get()));
+
+      ngram::Config config(config_);
+      config.write_mmap = file_.c_str();
+      std::string error;
+      boost::thread builder(BuildThread(read_end.release(), drain.get(), model_type_, config, error));
+      try {
+        PrintARPA(vocab_fd_, write_end.get(), counts_).Run(positions);
+      } catch (...) {
+        write_end.reset();
+        builder.join();
+        throw;
+      }
+      write_end.reset();
+      builder.join();
+      UTIL_THROW_IF(!error.empty(), util::Exception, "Building " << file_ << " failed: " << error);
+    }
+
+  private:
+    int vocab_fd_;
+    std::vector<uint64_t> counts_;
+    std::string file_;
+    ngram::ModelType model_type_;
+    ngram::Config config_;
+};
+
+// Memory for each order's chain when reading the buffer back for
+// PROB_RELEASED_HOOK.
+const std::size_t kReleasedChainMemory = 1 << 23;
+
+} // namespace
+
 OutputHook::~OutputHook() {}
 
 Output::Output(StringPiece file_base, bool keep_buffer, bool output_q)
@@ -16,21 +143,34 @@ Output::Output(StringPiece file_base, bool keep_buffer, bool output_q)
 
 void Output::SinkProbs(util::stream::Chains &chains) {
   Apply(PROB_PARALLEL_HOOK, chains);
-  if (!buffer_.Keep() && !Have(PROB_SEQUENTIAL_HOOK)) {
+  if (!buffer_.Keep() && !Have(PROB_SEQUENTIAL_HOOK) && !Have(PROB_RELEASED_HOOK)) {
     chains >> util::stream::kRecycle;
     chains.Wait(true);
     return;
   }
   buffer_.Sink(chains, header_.counts_pruned);
   chains >> util::stream::kRecycle;
-  chains.Wait(false);
+  chains.Wait(!Have(PROB_SEQUENTIAL_HOOK));
+  unsigned int step = 5;
   if (Have(PROB_SEQUENTIAL_HOOK)) {
-    std::cerr << "=== 5/5 Writing ARPA model ===" << std::endl;
+    std::cerr << "=== " << step++ << "/" << (4 + Steps()) << " Writing ARPA model ===" << std::endl;
     buffer_.Source(chains);
     Apply(PROB_SEQUENTIAL_HOOK, chains);
     chains >> util::stream::kRecycle;
     chains.Wait(true);
   }
+  if (Have(PROB_RELEASED_HOOK)) {
+    std::cerr << "=== " << step << "/" << (4 + Steps()) << " Building binary model ===" << std::endl;
+    // The pipeline's chains have released their memory by now.
+    util::stream::Chains small(chains.size());
+    for (std::size_t i = 0; i < chains.size(); ++i) {
+      small.push_back(util::stream::ChainConfig(NGram<BuildingPayload>::TotalSize(i + 1), 2, kReleasedChainMemory));
+    }
+    buffer_.Source(small);
+    Apply(PROB_RELEASED_HOOK, small);
+    small >> util::stream::kRecycle;
+    small.Wait(true);
+  }
 }
 
 void Output::Apply(HookType hook_type, util::stream::Chains &chains) {
@@ -49,4 +189,8 @@ void PrintHook::Sink(const HeaderInfo &info, int vocab_file, util::stream::Chain
   chains >> PrintARPA(vocab_file, file_.get(), info.counts_pruned);
 }
 
+void BinaryHook::Sink(const HeaderInfo &info, int vocab_file, util::stream::Chains &chains) {
+  chains >> PrintBinary(vocab_file, info.counts_pruned, file_, model_type_, config_);
+}
+
 }} // namespaces
@@ -3,6 +3,8 @@
 
 #include "lm/builder/header_info.hh"
 #include "lm/common/model_buffer.hh"
+#include "lm/config.hh"
+#include "lm/model_type.hh"
 #include "util/file.hh"
 
 #include <boost/ptr_container/ptr_vector.hpp>
@@ -18,6 +20,7 @@ enum HookType {
   // TODO: counts.
   PROB_PARALLEL_HOOK, // Probability and backoff (or just q).  Output must process the orders in parallel or there will be a deadlock.
   PROB_SEQUENTIAL_HOOK, // Probability and backoff (or just q).  Output can process orders any way it likes.  This requires writing the data to disk then reading.  Useful for ARPA files, which put unigrams first etc.
+  PROB_RELEASED_HOOK, // Like PROB_SEQUENTIAL_HOOK, but runs after the pipeline has released its sorting memory (-S).  The data is read back through small chains, leaving the memory to outputs that need a lot of their own, like building a binary.
   NUMBER_OF_HOOKS // Keep this last so we know how many values there are.
 };
 
@@ -56,7 +59,7 @@ class Output : boost::noncopyable {
     // This is called by the pipeline.
     void SinkProbs(util::stream::Chains &chains);
 
-    unsigned int Steps() const { return Have(PROB_SEQUENTIAL_HOOK); }
+    unsigned int Steps() const { return Have(PROB_SEQUENTIAL_HOOK) + Have(PROB_RELEASED_HOOK); }
 
   private:
     void Apply(HookType hook_type, util::stream::Chains &chains);
@@ -80,6 +83,30 @@ class PrintHook : public OutputHook {
     bool verbose_header_;
 };
 
+/* Builds a KenLM binary file (probing or trie) without an ARPA file on disk.
+ * The ARPA text is still formatted and goes through a pipe to a thread that
+ * parses it as build_binary would.  Formatting and parsing cost as much as
+ * they do for build_binary, and this runs after the rest of the pipeline;
+ * what is saved is the temporary file and running build_binary separately.
+ *
+ * This runs after lmplz has released its -S memory, so peak memory is the
+ * larger of -S and what build_binary would take: the whole probing model,
+ * or the trie's --binary_memory for sorting plus the pages being written.
+ */
+class BinaryHook : public OutputHook {
+  public:
+    // config's write_mmap is ignored; file names the binary.
+    BinaryHook(const std::string &file, ngram::ModelType model_type, const ngram::Config &config)
+      : OutputHook(PROB_RELEASED_HOOK), file_(file), model_type_(model_type), config_(config) {}
+
+    void Sink(const HeaderInfo &info, int vocab_file, util::stream::Chains &chains);
+
+  private:
+    std::string file_;
+    ngram::ModelType model_type_;
+    ngram::Config config_;
+};
+
 }} // namespaces
 
 #endif // LM_BUILDER_OUTPUT_H
@@ -16,6 +16,7 @@
 #include "util/exception.hh"
 #include "util/file.hh"
 #include "util/stream/io.hh"
+#include "util/usage.hh"
 
 #include <algorithm>
 #include <iostream>
@@ -41,6 +42,37 @@ void PrintStatistics(const std::vector<uint64_t> &counts, const std::vector<uint
   }
 }
 
+// Reports how long each step took and how fast it went.  This is not done
+// through util::stream::MultiProgress: its bar is only drawn when stderr is a
+// terminal and counts bytes of the last order's chain, while these lines are
+// meant for logs and count tokens or n-grams over all orders.
+class StepTimer {
+  public:
+    StepTimer() : start_(util::WallTime()) {}
+
+    void Report(const char *step, uint64_t records, const char *unit) {
+      double now = util::WallTime();
+      double took = now - start_;
+      std::cerr << step << " took " << took << " seconds";
+      if (took > 0.0) {
+        std::cerr << ", " << static_cast<uint64_t>(static_cast<double>(records) / took) << ' ' << unit << "/second";
+      }
+      std::cerr << std::endl;
+      start_ = now;
+    }
+
+  private:
+    double start_;
+};
+
+uint64_t Sum(const std::vector<uint64_t> &counts) {
+  uint64_t ret = 0;
+  for (std::size_t i = 0; i < counts.size(); ++i) {
+    ret += counts[i];
+  }
+  return ret;
+}
+
 class Master {
   public:
     explicit Master(PipelineConfig &config, unsigned output_steps)
@@ -219,7 +251,7 @@ util::stream::Sort<SuffixOrder, CombineCounts> *CountText(int text_file /* input
     // This much memory to work with after vocab hash table.
     static_cast<float>(config.TotalMemory() - vocab_usage) /
     // Solve for block size including the dedupe multiplier for one block.
-    (static_cast<float>(config.block_count) + CorpusCount::DedupeMultiplier(config.order)) *
+    (static_cast<float>(config.block_count) + CorpusCount::CountingMultiplier(config.order, config.threads)) *
     // Chain likes memory expressed in terms of total memory.
     static_cast<float>(config.block_count);
   util::stream::Chain chain(util::stream::ChainConfig(NGram<BuildingPayload>::TotalSize(config.order), config.block_count, memory_for_chain));
@@ -227,7 +259,7 @@ util::stream::Sort<SuffixOrder, CombineCounts> *CountText(int text_file /* input
   type_count = config.vocab_estimate;
   util::FilePiece text(text_file, NULL, &std::cerr);
   text_file_name = text.FileName();
-  CorpusCount counter(text, vocab_file, token_count, type_count, prune_words, config.prune_vocab_file, chain.BlockSize() / chain.EntrySize(), config.disallowed_symbol_action);
+  CorpusCount counter(text, vocab_file, token_count, type_count, prune_words, config.prune_vocab_file, chain.BlockSize() / chain.EntrySize(), config.disallowed_symbol_action, config.threads);
   chain >> boost::ref(counter);
 
   util::scoped_ptr<util::stream::Sort<SuffixOrder, CombineCounts> > sorter(new util::stream::Sort<SuffixOrder, CombineCounts>(chain, config.sort, SuffixOrder(config.order), CombineCounts()));
@@ -235,13 +267,14 @@ util::stream::Sort<SuffixOrder, CombineCounts> *CountText(int text_file /* input
   return sorter.release();
 }
 
-void InitialProbabilities(const std::vector<uint64_t> &counts, const std::vector<uint64_t> &counts_pruned, const std::vector<Discount> &discounts, Master &master, Sorts<SuffixOrder> &primary, util::FixedArray<util::stream::FileBuffer> &gammas, const std::vector<uint64_t> &prune_thresholds, bool prune_vocab, const SpecialVocab &specials) {
+void InitialProbabilities(const std::vector<uint64_t> &counts, const std::vector<uint64_t> &counts_pruned, const std::vector<Discount> &discounts, Master &master, Sorts<SuffixOrder> &primary, util::FixedArray<util::stream::FileBuffer> &gammas, const std::vector<uint64_t> &prune_thresholds, bool prune_vocab, const SpecialVocab &specials, StepTimer &timer) {
   const PipelineConfig &config = master.Config();
   util::stream::Chains second(config.order);
 
   {
     Sorts<ContextOrder> sorts;
     master.SetupSorts(sorts, !config.renumber_vocabulary);
+    timer.Report("Adjusting counts", Sum(counts), "n-grams");
     PrintStatistics(counts, counts_pruned, discounts);
     lm::ngram::ShowSizes(counts_pruned);
     std::cerr << "=== 3/" << master.Steps() << " Calculating and sorting initial probabilities ===" << std::endl;
@@ -259,6 +292,7 @@ void InitialProbabilities(const std::vector<uint64_t> &counts, const std::vector
   }
   // Has to be done here due to gamma_chains scope.
   master.SetupSorts(primary, true);
+  timer.Report("Initial probabilities", Sum(counts_pruned), "n-grams");
 }
 
 void InterpolateProbabilities(const std::vector<uint64_t> &counts, Master &master, Sorts<SuffixOrder> &primary, util::FixedArray<util::stream::FileBuffer> &gammas, Output &output, const SpecialVocab &specials) {
@@ -351,9 +385,11 @@ void Pipeline(PipelineConfig &config, int text_file, Output &output) {
     WordIndex type_count;
     std::string text_file_name;
     std::vector<bool> prune_words;
+    StepTimer timer;
     util::scoped_ptr<util::stream::Sort<SuffixOrder, CombineCounts> > sorted_counts(
         CountText(text_file, numbering.WriteOnTheFly(), master, token_count, type_count, text_file_name, prune_words));
     std::cerr << "Unigram tokens " << token_count << " types " << type_count << std::endl;
+    timer.Report("Counting", token_count, "tokens");
 
     // Create vocab mapping, which uses temporary memory, while nothing else is happening.
     std::size_t subtract_for_numbering = numbering.ComputeMapping(type_count);
@@ -371,10 +407,11 @@ void Pipeline(PipelineConfig &config, int text_file, Output &output) {
     {
       util::FixedArray<util::stream::FileBuffer> gammas;
       Sorts<SuffixOrder> primary;
-      InitialProbabilities(counts, counts_pruned, discounts, master, primary, gammas, config.prune_thresholds, config.prune_vocab, numbering.Specials());
+      InitialProbabilities(counts, counts_pruned, discounts, master, primary, gammas, config.prune_thresholds, config.prune_vocab, numbering.Specials(), timer);
       output.SetHeader(HeaderInfo(text_file_name, token_count, counts_pruned));
       // Also does output.
       InterpolateProbabilities(counts_pruned, master, primary, gammas, output, numbering.Specials());
+      timer.Report("Interpolating and writing", Sum(counts_pruned), "n-grams");
     }
   } catch (const util::Exception &e) {
     std::cerr << e.what() << std::endl;
@@ -32,6 +32,10 @@ struct PipelineConfig {
   // Number of blocks to use.  This will be overridden to 1 if everything fits.
   std::size_t block_count;
 
+  // Threads that deduplicate n-grams while counting.  The corpus is still
+  // read by one thread.
+  std::size_t threads;
+
   // n-gram count thresholds for pruning. 0 values means no pruning for
   // corresponding n-gram order
   std::vector<uint64_t> prune_thresholds; //mjd
@@ -65,6 +65,11 @@ struct Config {
   // models.
   std::size_t building_memory;
 
+  // Threads to use for building from ARPA.  ARPA parsing is spread over them
+  // and, for trie models, sorting and merging too.  The binary file is the
+  // same for any number.
+  std::size_t building_threads;
+
   // Template for temporary directory appropriate for passing to mkdtemp.
   // The characters XXXXXX are appended before passing to mkdtemp.  Only
   // applies to trie.  If empty, defaults to write_mmap.  If that's NULL,
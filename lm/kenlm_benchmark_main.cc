@@ -1,3 +1,4 @@
+#include "lm/binary_format.hh"
 #include "lm/model.hh"
 #include "util/file_stream.hh"
 #include "util/file.hh"
@@ -5,6 +6,7 @@
 #include "util/usage.hh"
 
 #include <stdint.h>
+#include <vector>
 
 namespace {
 
@@ -67,53 +69,146 @@ template <class Model, class Width> void QueryFromBytes(const Model &model, int
   std::cout << "RSSMax: " << util::RSSMax() << std::endl;
 }
 
-template <class Model, class Width> void DispatchFunction(const Model &model, bool query) {
-  if (query) {
-    QueryFromBytes<Model, Width>(model, 0);
-  } else {
-    ConvertToBytes<Model, Width>(model, 0);
+// Same queries as QueryFromBytes, but the input is cut at sentence boundaries
+// into kStreams independent streams that advance in lockstep through
+// FullScoreBatch.
+template <class Model, class Width> void BatchQueryFromBytes(const Model &model, int fd_in) {
+  const std::size_t kStreams = 64;
+  Width kEOS = model.GetVocabulary().EndSentence();
+
+  std::vector<Width> words;
+  Width buf[4096];
+  while (std::size_t got = util::ReadOrEOF(fd_in, buf, sizeof(buf))) {
+    UTIL_THROW_IF2(got % sizeof(Width), "File size not a multiple of vocab id size " << sizeof(Width));
+    words.insert(words.end(), buf, buf + got / sizeof(Width));
+  }
+
+  double loaded = util::CPUTime();
+  std::cout << "CPU_to_load: " << loaded << std::endl;
+
+  // Stream boundaries, each just after an end of sentence.
+  std::vector<std::size_t> cursor, end;
+  std::size_t from = 0;
+  for (std::size_t s = 1; s <= kStreams && from < words.size(); ++s) {
+    std::size_t to = words.size() * s / kStreams;
+    while (to < words.size() && to > from && words[to - 1] != kEOS) ++to;
+    if (to <= from) continue;
+    cursor.push_back(from);
+    end.push_back(to);
+    from = to;
   }
+  const std::size_t streams = cursor.size();
+
+  // Two states per stream, alternating between in and out.
+  std::vector<lm::ngram::State> state(2 * streams);
+  std::vector<const lm::ngram::State*> in(streams, &model.BeginSentenceState());
+  std::vector<const lm::ngram::State*> batch_in(streams);
+  std::vector<lm::ngram::State*> out(streams);
+  std::vector<lm::WordIndex> queries(streams);
+  std::vector<lm::FullScoreReturn> ret(streams);
+  std::vector<std::size_t> active(streams);
+
+  double total = 0.0;
+  while (true) {
+    std::size_t count = 0;
+    for (std::size_t s = 0; s < streams; ++s) {
+      if (cursor[s] == end[s]) continue;
+      batch_in[count] = in[s];
+      queries[count] = words[cursor[s]];
+      out[count] = &state[2 * s + (cursor[s] & 1)];
+      active[count++] = s;
+    }
+    if (!count) break;
+    model.FullScoreBatch(&batch_in[0], &queries[0], &out[0], &ret[0], count);
+    float sum = 0.0;
+    for (std::size_t i = count; i;) {
+      --i;
+      std::size_t s = active[i];
+      sum += ret[i].prob;
+      in[s] = (words[cursor[s]++] == kEOS) ? &model.BeginSentenceState() : out[i];
+    }
+    total += sum;
+  }
+  double after = util::CPUTime();
+  std::cerr << "Probability sum is " << total << std::endl;
+  std::cout << "Queries: " << words.size() << std::endl;
+  std::cout << "Streams: " << streams << std::endl;
+  std::cout << "CPU_excluding_load: " << (after - loaded) << "\nCPU_per_query: " << ((after - loaded) / static_cast<double>(words.size())) << std::endl;
+  std::cout << "RSSMax: " << util::RSSMax() << std::endl;
 }
 
-template <class Model> void DispatchWidth(const char *file, bool query) {
+enum Mode { VOCAB, QUERY, BATCH };
+
+// Size of the binary file per n-gram, to compare data structures.
+template <class Model> void ReportSize(const char *file) {
+  lm::ngram::Parameters params;
+  lm::ngram::BinaryFormat format((lm::ngram::Config()));
+  format.InitializeBinary(util::OpenReadOrThrow(file), Model::kModelType, Model::kVersion, params);
+  uint64_t ngrams = 0;
+  for (std::size_t i = 0; i < params.counts.size(); ++i) ngrams += params.counts[i];
+  uint64_t bytes = util::SizeOrThrow(util::scoped_fd(util::OpenReadOrThrow(file)).get());
+  std::cout << "Bytes: " << bytes << "\nNgrams: " << ngrams << "\nBytes_per_ngram: " << (static_cast<double>(bytes) / static_cast<double>(ngrams)) << std::endl;
+}
+
+template <class Model, class Width> void DispatchFunction(const Model &model, Mode mode) {
+  switch (mode) {
+    case QUERY:
+      QueryFromBytes<Model, Width>(model, 0);
+      break;
+    case BATCH:
+      BatchQueryFromBytes<Model, Width>(model, 0);
+      break;
+    default:
+      ConvertToBytes<Model, Width>(model, 0);
+  }
+}
+
+template <class Model> void DispatchWidth(const char *file, Mode mode) {
   lm::ngram::Config config;
   config.load_method = util::READ;
   std::cerr << "Using load_method = READ." << std::endl;
   Model model(file, config);
+  if (mode != VOCAB) ReportSize<Model>(file);
   lm::WordIndex bound = model.GetVocabulary().Bound();
   if (bound <= 256) {
-    DispatchFunction<Model, uint8_t>(model, query);
+    DispatchFunction<Model, uint8_t>(model, mode);
   } else if (bound <= 65536) {
-    DispatchFunction<Model, uint16_t>(model, query);
+    DispatchFunction<Model, uint16_t>(model, mode);
   } else if (bound <= (1ULL << 32)) {
-    DispatchFunction<Model, uint32_t>(model, query);
+    DispatchFunction<Model, uint32_t>(model, mode);
   } else {
-    DispatchFunction<Model, uint64_t>(model, query);
+    DispatchFunction<Model, uint64_t>(model, mode);
   }
 }
 
-void Dispatch(const char *file, bool query) {
+void Dispatch(const char *file, Mode mode) {
   using namespace lm::ngram;
   lm::ngram::ModelType model_type;
   if (lm::ngram::RecognizeBinary(file, model_type)) {
     switch(model_type) {
       case PROBING:
-        DispatchWidth<lm::ngram::ProbingModel>(file, query);
+        DispatchWidth<lm::ngram::ProbingModel>(file, mode);
         break;
       case REST_PROBING:
-        DispatchWidth<lm::ngram::RestProbingModel>(file, query);
+        DispatchWidth<lm::ngram::RestProbingModel>(file, mode);
         break;
       case TRIE:
-        DispatchWidth<lm::ngram::TrieModel>(file, query);
+        DispatchWidth<lm::ngram::TrieModel>(file, mode);
         break;
       case QUANT_TRIE:
-        DispatchWidth<lm::ngram::QuantTrieModel>(file, query);
+        DispatchWidth<lm::ngram::QuantTrieModel>(file, mode);
         break;
       case ARRAY_TRIE:
-        DispatchWidth<lm::ngram::ArrayTrieModel>(file, query);
+        DispatchWidth<lm::ngram::ArrayTrieModel>(file, mode);
         break;
       case QUANT_ARRAY_TRIE:
-        DispatchWidth<lm::ngram::QuantArrayTrieModel>(file, query);
+        DispatchWidth<lm::ngram::QuantArrayTrieModel>(file, mode);
+        break;
+      case EF_TRIE:
+        DispatchWidth<lm::ngram::EliasFanoTrieModel>(file, mode);
+        break;
+      case QUANT_EF_TRIE:
+        DispatchWidth<lm::ngram::QuantEliasFanoTrieModel>(file, mode);
         break;
       default:
         UTIL_THROW(util::Exception, "Unrecognized kenlm model type " << model_type);
@@ -126,7 +221,7 @@ void Dispatch(const char *file, bool query) {
 } // namespace
 
 int main(int argc, char *argv[]) {
-  if (argc != 3 || (strcmp(argv[1], "vocab") && strcmp(argv[1], "query"))) {
+  if (argc != 3 || (strcmp(argv[1], "vocab") && strcmp(argv[1], "query") && strcmp(argv[1], "batch"))) {
     std::cerr
       << "Benchmark program for KenLM.  Intended usage:\n"
       << "#Convert text to vocabulary ids offline.  These ids are tied to a model.\n"
@@ -134,9 +229,16 @@ int main(int argc, char *argv[]) {
       << "#Ensure files are in RAM.\n"
       << "cat $text.vocab $model >/dev/null\n"
       << "#Timed query against the model.\n"
-      << argv[0] << " query $model <$text.vocab\n";
+      << argv[0] << " query $model <$text.vocab\n"
+      << "#Same queries, as independent streams scored with prefetching batches.\n"
+      << argv[0] << " batch $model <$text.vocab\n"
+      << "#To compare data structures, e.g. build_binary trie with and without -a or -e, query each\n"
+      << "#with the same $text.vocab.  The vocabulary ids of all trie variants are the same.\n";
     return 1;
   }
-  Dispatch(argv[2], !strcmp(argv[1], "query"));
+  Mode mode = VOCAB;
+  if (!strcmp(argv[1], "query")) mode = QUERY;
+  if (!strcmp(argv[1], "batch")) mode = BATCH;
+  Dispatch(argv[2], mode);
   return 0;
 }
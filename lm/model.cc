@@ -40,7 +40,7 @@ void ComplainAboutARPA(const Config &config, ModelType model_type) {
   if (config.arpa_complain == Config::ALL) {
     *config.messages << "Loading the LM will be faster if you build a binary file." << std::endl;
   } else if (config.arpa_complain == Config::EXPENSIVE &&
-             (model_type == TRIE || model_type == QUANT_TRIE || model_type == ARRAY_TRIE || model_type == QUANT_ARRAY_TRIE)) {
+             (model_type == TRIE || model_type == QUANT_TRIE || model_type == ARRAY_TRIE || model_type == QUANT_ARRAY_TRIE || model_type == EF_TRIE || model_type == QUANT_EF_TRIE)) {
     *config.messages << "Building " << kModelNames[model_type] << " from ARPA is expensive.  Save time by building a binary format." << std::endl;
   }
 }
@@ -75,7 +75,16 @@ template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::Ge
     ComplainAboutARPA(init_config, kModelType);
     InitializeFromARPA(fd.release(), file, init_config);
   }
+  InitializeStates();
+}
+
+template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::GenericModel(int fd, const char *file, const Config &init_config) : backing_(init_config) {
+  ComplainAboutARPA(init_config, kModelType);
+  InitializeFromARPA(fd, file, init_config);
+  InitializeStates();
+}
 
+template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT>::InitializeStates() {
   // g++ prints warnings unless these are fully initialized.
   State begin_sentence = State();
   begin_sentence.length = 1;
@@ -139,6 +148,24 @@ template <class Search, class VocabularyT> FullScoreReturn GenericModel<Search,
   return ret;
 }
 
+namespace {
+// How many queries ahead of the current one FullScoreBatch prefetches.
+const std::size_t kPrefetchDistance = 8;
+} // namespace
+
+template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT>::FullScoreBatch(const State *const *in_states, const WordIndex *new_words, State *const *out_states, FullScoreReturn *ret, std::size_t count) const {
+  std::size_t ahead = std::min(count, kPrefetchDistance);
+  for (std::size_t i = 0; i < ahead; ++i) {
+    search_.Prefetch(new_words[i], in_states[i]->words, in_states[i]->words + in_states[i]->length);
+  }
+  for (std::size_t i = 0; i < count; ++i, ++ahead) {
+    if (ahead < count) {
+      search_.Prefetch(new_words[ahead], in_states[ahead]->words, in_states[ahead]->words + in_states[ahead]->length);
+    }
+    ret[i] = FullScore(*in_states[i], new_words[i], *out_states[i]);
+  }
+}
+
 template <class Search, class VocabularyT> FullScoreReturn GenericModel<Search, VocabularyT>::FullScoreForgotState(const WordIndex *context_rbegin, const WordIndex *context_rend, const WordIndex new_word, State &out_state) const {
   context_rend = std::min(context_rend, context_rbegin + P::Order() - 1);
   FullScoreReturn ret = ScoreExceptBackoff(context_rbegin, context_rend, new_word, out_state);
@@ -322,6 +349,8 @@ template class GenericModel<trie::TrieSearch<DontQuantize, trie::DontBhiksha>, S
 template class GenericModel<trie::TrieSearch<DontQuantize, trie::ArrayBhiksha>, SortedVocabulary>;
 template class GenericModel<trie::TrieSearch<SeparatelyQuantize, trie::DontBhiksha>, SortedVocabulary>;
 template class GenericModel<trie::TrieSearch<SeparatelyQuantize, trie::ArrayBhiksha>, SortedVocabulary>;
+template class GenericModel<trie::TrieSearch<DontQuantize, trie::EliasFanoBhiksha>, SortedVocabulary>;
+template class GenericModel<trie::TrieSearch<SeparatelyQuantize, trie::EliasFanoBhiksha>, SortedVocabulary>;
 
 } // namespace detail
 
@@ -340,6 +369,10 @@ base::Model *LoadVirtual(const char *file_name, const Config &config, ModelType
       return new ArrayTrieModel(file_name, config);
     case QUANT_ARRAY_TRIE:
       return new QuantArrayTrieModel(file_name, config);
+    case EF_TRIE:
+      return new EliasFanoTrieModel(file_name, config);
+    case QUANT_EF_TRIE:
+      return new QuantEliasFanoTrieModel(file_name, config);
     default:
       UTIL_THROW(FormatLoadException, "Confused by model type " << model_type);
   }
@@ -50,12 +50,26 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     explicit GenericModel(const char *file, const Config &config = Config());
 
+    /* Load the model from an ARPA file that is read once, front to back,
+     * from fd.  It may be a pipe, e.g. from lmplz.  Takes ownership of fd.
+     * file is only used in messages.
+     */
+    GenericModel(int fd, const char *file, const Config &config = Config());
+
     /* Score p(new_word | in_state) and incorporate new_word into out_state.
      * Note that in_state and out_state must be different references:
      * &in_state != &out_state.
      */
     FullScoreReturn FullScore(const State &in_state, const WordIndex new_word, State &out_state) const;
 
+    /* Batched FullScore.  For each i in [0, count), score new_words[i] given
+     * *in_states[i], writing *out_states[i] and ret[i].  Hash table buckets
+     * are prefetched a few queries ahead of the one being resolved, so the
+     * cache misses of independent queries overlap.  No out_state may alias an
+     * in_state of the same batch.
+     */
+    void FullScoreBatch(const State *const *in_states, const WordIndex *new_words, State *const *out_states, FullScoreReturn *ret, std::size_t count) const;
+
     /* Slower call without in_state.  Try to remember state, but sometimes it
      * would cost too much memory or your decoder isn't setup properly.
      * To use this function, make an array of WordIndex containing the context
@@ -113,6 +127,9 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 
     void InitializeFromARPA(int fd, const char *file, const Config &config);
 
+    // Begin sentence and null context states, once the model is loaded.
+    void InitializeStates();
+
     float InternalUnRest(const uint64_t *pointers_begin, const uint64_t *pointers_end, unsigned char first_length) const;
 
     BinaryFormat backing_;
@@ -131,6 +148,7 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 class name : public from {\
   public:\
     name(const char *file, const Config &config = Config()) : from(file, config) {}\
+    name(int fd, const char *file, const Config &config = Config()) : from(fd, file, config) {}\
 };
 
 LM_NAME_MODEL(ProbingModel, detail::GenericModel<detail::HashedSearch<BackoffValue> LM_COMMA() ProbingVocabulary>);
@@ -139,6 +157,8 @@ LM_NAME_MODEL(TrieModel, detail::GenericModel<trie::TrieSearch<DontQuantize LM_C
 LM_NAME_MODEL(ArrayTrieModel, detail::GenericModel<trie::TrieSearch<DontQuantize LM_COMMA() trie::ArrayBhiksha> LM_COMMA() SortedVocabulary>);
 LM_NAME_MODEL(QuantTrieModel, detail::GenericModel<trie::TrieSearch<SeparatelyQuantize LM_COMMA() trie::DontBhiksha> LM_COMMA() SortedVocabulary>);
 LM_NAME_MODEL(QuantArrayTrieModel, detail::GenericModel<trie::TrieSearch<SeparatelyQuantize LM_COMMA() trie::ArrayBhiksha> LM_COMMA() SortedVocabulary>);
+LM_NAME_MODEL(EliasFanoTrieModel, detail::GenericModel<trie::TrieSearch<DontQuantize LM_COMMA() trie::EliasFanoBhiksha> LM_COMMA() SortedVocabulary>);
+LM_NAME_MODEL(QuantEliasFanoTrieModel, detail::GenericModel<trie::TrieSearch<SeparatelyQuantize LM_COMMA() trie::EliasFanoBhiksha> LM_COMMA() SortedVocabulary>);
 
 // Default implementation.  No real reason for it to be the default.
 typedef ::lm::ngram::ProbingVocabulary Vocabulary;
@@ -2,6 +2,9 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
 
 #define BOOST_TEST_MODULE ModelTest
 #include <boost/test/unit_test.hpp>
@@ -278,6 +281,34 @@ template <class M> void Stateless(const M &model) {
   BOOST_CHECK_EQUAL(static_cast<WordIndex>(0), state.words[0]);
 }
 
+template <class M> void Batched(const M &model) {
+  const char *words[] = {"looking", "on", "a", "little", "the", "biarritz", "not_found", "more", ".", "</s>"};
+  const size_t num_words = sizeof(words) / sizeof(const char*);
+  WordIndex indices[num_words];
+  State states[num_words + 1];
+  FullScoreReturn single[num_words];
+  states[0] = model.BeginSentenceState();
+  for (size_t i = 0; i < num_words; ++i) {
+    indices[i] = model.GetVocabulary().Index(words[i]);
+    single[i] = model.FullScore(states[i], indices[i], states[i + 1]);
+  }
+
+  const State *in[num_words];
+  State out[num_words];
+  State *out_ptrs[num_words];
+  FullScoreReturn batched[num_words];
+  for (size_t i = 0; i < num_words; ++i) {
+    in[i] = &states[i];
+    out_ptrs[i] = &out[i];
+  }
+  model.FullScoreBatch(in, indices, out_ptrs, batched, num_words);
+  for (size_t i = 0; i < num_words; ++i) {
+    SLOPPY_CHECK_CLOSE(single[i].prob, batched[i].prob, 0.001);
+    BOOST_CHECK_EQUAL(single[i].ngram_length, batched[i].ngram_length);
+    BOOST_CHECK_EQUAL(states[i + 1], out[i]);
+  }
+}
+
 template <class M> void NoUnkCheck(const M &model) {
   WordIndex unk_index = 0;
   State state;
@@ -294,6 +325,7 @@ template <class M> void Everything(const M &m) {
   MinimalState(m);
   ExtendLeftTest(m);
   Stateless(m);
+  Batched(m);
 }
 
 class ExpectEnumerateVocab : public EnumerateVocab {
@@ -359,6 +391,12 @@ BOOST_AUTO_TEST_CASE(bhiksha_trie) {
 BOOST_AUTO_TEST_CASE(quant_bhiksha_trie) {
   LoadingTest<QuantArrayTrieModel>();
 }
+BOOST_AUTO_TEST_CASE(elias_fano_trie) {
+  LoadingTest<EliasFanoTrieModel>();
+}
+BOOST_AUTO_TEST_CASE(quant_elias_fano_trie) {
+  LoadingTest<QuantEliasFanoTrieModel>();
+}
 
 template <class ModelT> void BinaryTest(Config::WriteMethod write_method) {
   Config config;
@@ -430,6 +468,45 @@ BOOST_AUTO_TEST_CASE(write_and_read_array_trie) {
 BOOST_AUTO_TEST_CASE(write_and_read_quant_array_trie) {
   BinaryTest<QuantArrayTrieModel>();
 }
+BOOST_AUTO_TEST_CASE(write_and_read_elias_fano_trie) {
+  BinaryTest<EliasFanoTrieModel>();
+}
+BOOST_AUTO_TEST_CASE(write_and_read_quant_elias_fano_trie) {
+  BinaryTest<QuantEliasFanoTrieModel>();
+}
+
+std::string FileContents(const char *name) {
+  std::ifstream in(name, std::ios::binary);
+  std::ostringstream out;
+  out << in.rdbuf();
+  return out.str();
+}
+
+// Building with several threads gives the same file as with one.
+template <class ModelT> void ThreadedBuildTest() {
+  Config config;
+  config.messages = NULL;
+  config.write_mmap = "test_serial.binary";
+  {
+    ModelT model(TestLocation(), config);
+  }
+  config.building_threads = 3;
+  config.write_mmap = "test_threaded.binary";
+  {
+    ModelT model(TestLocation(), config);
+    Everything(model);
+  }
+  BOOST_CHECK(FileContents("test_serial.binary") == FileContents("test_threaded.binary"));
+  unlink("test_serial.binary");
+  unlink("test_threaded.binary");
+}
+
+BOOST_AUTO_TEST_CASE(threaded_build_probing) {
+  ThreadedBuildTest<ProbingModel>();
+}
+BOOST_AUTO_TEST_CASE(threaded_build_quant_array_trie) {
+  ThreadedBuildTest<QuantArrayTrieModel>();
+}
 
 BOOST_AUTO_TEST_CASE(rest_max) {
   Config config;
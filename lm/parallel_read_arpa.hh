@@ -0,0 +1,225 @@
+#ifndef LM_PARALLEL_READ_ARPA_H
+#define LM_PARALLEL_READ_ARPA_H
+
+#include "lm/lm_exception.hh"
+#include "lm/read_arpa.hh"
+#include "lm/word_index.hh"
+#include "util/file_piece.hh"
+#include "util/string_piece.hh"
+
+#ifdef WITH_THREADS
+#include "util/pcqueue.hh"
+
+#include <boost/bind.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace lm {
+
+/* Reads the count n-grams of one order, as if ReadNGram were called count
+ * times.  With more than one thread, one thread copies lines out of the
+ * FilePiece in batches and the others parse them.  Read still returns
+ * n-grams in file order, so anything built from them is the same for any
+ * number of threads.  Don't touch the FilePiece until this is destroyed.
+ * Without WITH_THREADS, this is ReadNGram.
+ */
+template <class Voc, class Weights> class NGramReader {
+  public:
+    NGramReader(util::FilePiece &f, unsigned char n, std::size_t count, const Voc &vocab, PositiveProbWarn &warn, std::size_t threads)
+      : f_(f), n_(n), count_(count), vocab_(vocab), warn_(warn)
+#ifdef WITH_THREADS
+      , threads_(threads > 1 ? threads : 0), current_(NULL), at_(0), next_(0), finished_(0), stop_(false) {
+      if (!threads_) return;
+      for (std::size_t i = 0; i < threads_; ++i) {
+        in_.push_back(new util::PCQueue<Batch*>(2));
+        out_.push_back(new util::PCQueue<Batch*>(2));
+      }
+      for (std::size_t i = 0; i < threads_; ++i) {
+        workers_.create_thread(boost::bind(&NGramReader::Parse, this, i));
+      }
+      workers_.create_thread(boost::bind(&NGramReader::ReadLines, this));
+    }
+#else
+      {}
+#endif
+
+    ~NGramReader() {
+#ifdef WITH_THREADS
+      if (!threads_) return;
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        stop_ = true;
+      }
+      // Take what is left in the queues so that nobody is blocked.
+      delete current_;
+      while (finished_ < threads_) {
+        if (Batch *batch = out_[next_++ % threads_].Consume()) {
+          delete batch;
+        } else {
+          ++finished_;
+        }
+      }
+      workers_.join_all();
+#endif
+    }
+
+    // Like ReadNGram: words go to indices_out in file order.
+    template <class Iterator> void Read(Iterator indices_out, Weights &weights) {
+#ifdef WITH_THREADS
+      if (threads_) {
+        while (!current_ || at_ == current_->parsed) NextBatch();
+        const WordIndex *words = &current_->words[at_ * n_];
+        std::copy(words, words + n_, indices_out);
+        weights = current_->weights[at_];
+        ++at_;
+        return;
+      }
+#endif
+      ReadNGram(f_, n_, vocab_, indices_out, weights, warn_);
+    }
+
+  private:
+    util::FilePiece &f_;
+    const unsigned char n_;
+    const std::size_t count_;
+    const Voc &vocab_;
+    PositiveProbWarn &warn_;
+
+#ifdef WITH_THREADS
+    // Lines per batch.
+    static const std::size_t kBatchLines = 8192;
+
+    struct Batch {
+      // Byte offset of text in the ARPA file, for error messages.
+      uint64_t offset;
+      std::size_t lines;
+      std::string text;
+
+      // Parsed lines, words in file order.
+      std::size_t parsed;
+      std::vector<WordIndex> words;
+      std::vector<Weights> weights;
+      // Why parsing stopped before the end of the batch.
+      std::string error;
+    };
+
+    void NextBatch() {
+      if (current_ && !current_->error.empty()) {
+        UTIL_THROW(FormatLoadException, current_->error);
+      }
+      delete current_;
+      current_ = out_[next_++ % threads_].Consume();
+      at_ = 0;
+      if (!current_) {
+        ++finished_;
+        boost::mutex::scoped_lock lock(mutex_);
+        UTIL_THROW(FormatLoadException, (read_error_.empty() ? "The ARPA file ended early" : read_error_));
+      }
+    }
+
+    // Batches go to the parsers in turn, so NextBatch can take them back in order.
+    void ReadLines() {
+      std::size_t batch_index = 0;
+      try {
+        for (std::size_t remaining = count_; remaining; ++batch_index) {
+          {
+            boost::mutex::scoped_lock lock(mutex_);
+            if (stop_) break;
+          }
+          Batch *batch = new Batch();
+          batch->offset = f_.Offset();
+          batch->lines = remaining < kBatchLines ? remaining : kBatchLines;
+          batch->parsed = 0;
+          try {
+            for (std::size_t i = 0; i < batch->lines; ++i) {
+              StringPiece line(f_.ReadLine('\n', false));
+              batch->text.append(line.data(), line.size());
+              batch->text += '\n';
+            }
+          } catch (...) {
+            delete batch;
+            throw;
+          }
+          remaining -= batch->lines;
+          in_[batch_index % threads_].Produce(batch);
+        }
+      } catch (const util::Exception &e) {
+        boost::mutex::scoped_lock lock(mutex_);
+        read_error_ = e.what();
+      }
+      // One end marker per parser, continuing the rotation.
+      for (std::size_t i = 0; i < threads_; ++i) {
+        in_[(batch_index + i) % threads_].Produce(NULL);
+      }
+    }
+
+    // The caller's warning, shared by the parsers so that it complains once.
+    class LockedWarn {
+      public:
+        LockedWarn(PositiveProbWarn &warn, boost::mutex &mutex) : warn_(warn), mutex_(mutex) {}
+
+        void Warn(float prob) {
+          boost::mutex::scoped_lock lock(mutex_);
+          warn_.Warn(prob);
+        }
+
+      private:
+        PositiveProbWarn &warn_;
+        boost::mutex &mutex_;
+    };
+
+    void Parse(std::size_t index) {
+      LockedWarn warn(warn_, warn_mutex_);
+      Batch *batch;
+      while ((batch = in_[index].Consume())) {
+        batch->words.resize(batch->lines * n_);
+        batch->weights.resize(batch->lines);
+        try {
+          std::istringstream stream(batch->text);
+          util::FilePiece f(stream, NULL, batch->text.size() + 1);
+          for (; batch->parsed < batch->lines; ++batch->parsed) {
+            ReadNGram(f, n_, vocab_, batch->words.begin() + batch->parsed * n_, batch->weights[batch->parsed], warn);
+          }
+        } catch (const util::Exception &e) {
+          std::ostringstream message;
+          message << e.what() << " of the batch starting at byte " << batch->offset;
+          batch->error = message.str();
+        }
+        std::string().swap(batch->text);
+        out_[index].Produce(batch);
+      }
+      out_[index].Produce(NULL);
+    }
+
+    const std::size_t threads_;
+
+    boost::ptr_vector<util::PCQueue<Batch*> > in_, out_;
+    boost::thread_group workers_;
+
+    // Used by the thread calling Read.
+    Batch *current_;
+    std::size_t at_;
+    std::size_t next_;
+    std::size_t finished_;
+
+    boost::mutex mutex_;
+    bool stop_;
+    std::string read_error_;
+
+    boost::mutex warn_mutex_;
+#endif
+};
+
+} // namespace lm
+
+#endif // LM_PARALLEL_READ_ARPA_H
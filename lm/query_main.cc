@@ -93,6 +93,12 @@ int main(int argc, char *argv[]) {
         case QUANT_ARRAY_TRIE:
           Query<QuantArrayTrieModel>(file, config, sentence_context, printer);
           break;
+        case EF_TRIE:
+          Query<EliasFanoTrieModel>(file, config, sentence_context, printer);
+          break;
+        case QUANT_EF_TRIE:
+          Query<QuantEliasFanoTrieModel>(file, config, sentence_context, printer);
+          break;
         default:
           std::cerr << "Unrecognized kenlm model type " << model_type << std::endl;
           abort();
@@ -4,6 +4,7 @@
 #include "lm/blank.hh"
 #include "lm/lm_exception.hh"
 #include "lm/model.hh"
+#include "lm/parallel_read_arpa.hh"
 #include "lm/read_arpa.hh"
 #include "lm/value.hh"
 #include "lm/vocab.hh"
@@ -166,10 +167,14 @@ template <class Build, class Activate, class Store> void ReadNGrams(
     std::vector<util::ProbingHashTable<typename Build::Value::ProbingEntry, util::IdentityHash> > &middle,
     Activate activate,
     Store &store,
-    PositiveProbWarn &warn) {
+    PositiveProbWarn &warn,
+    std::size_t threads) {
   typedef typename Build::Value Value;
   assert(n >= 2);
   ReadNGramHeader(f, n);
+  // Parsing may be threaded, but n-grams are inserted in file order so the
+  // tables come out the same.
+  NGramReader<ProbingVocabulary, typename Store::Entry::Value> reader(f, n, count, vocab, warn, threads);
 
   // Both vocab_ids and keys are non-empty because n >= 2.
   // vocab ids of words in reverse order.
@@ -178,7 +183,7 @@ template <class Build, class Activate, class Store> void ReadNGrams(
   typename Store::Entry entry;
   std::vector<typename Value::Weights *> between;
   for (size_t i = 0; i < count; ++i) {
-    ReadNGram(f, n, vocab, vocab_ids.rbegin(), entry.value, warn);
+    reader.Read(vocab_ids.rbegin(), entry.value);
     build.SetRest(&*vocab_ids.begin(), n, entry.value);
 
     keys[0] = detail::CombineWordHash(static_cast<uint64_t>(vocab_ids.front()), vocab_ids[1]);
@@ -243,7 +248,7 @@ template <class Value> void HashedSearch<Value>::InitializeFromARPA(const char *
 
 template <> void HashedSearch<BackoffValue>::DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
   NoRestBuild build;
-  ApplyBuild(f, counts, vocab, warn, build);
+  ApplyBuild(f, counts, config, vocab, warn, build);
 }
 
 template <> void HashedSearch<RestValue>::DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
@@ -251,19 +256,19 @@ template <> void HashedSearch<RestValue>::DispatchBuild(util::FilePiece &f, cons
     case Config::REST_MAX:
       {
         MaxRestBuild build;
-        ApplyBuild(f, counts, vocab, warn, build);
+        ApplyBuild(f, counts, config, vocab, warn, build);
       }
       break;
     case Config::REST_LOWER:
       {
         LowerRestBuild<ProbingModel> build(config, counts.size(), vocab);
-        ApplyBuild(f, counts, vocab, warn, build);
+        ApplyBuild(f, counts, config, vocab, warn, build);
       }
       break;
   }
 }
 
-template <class Value> template <class Build> void HashedSearch<Value>::ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build) {
+template <class Value> template <class Build> void HashedSearch<Value>::ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build) {
   for (WordIndex i = 0; i < counts[0]; ++i) {
     build.SetRest(&i, (unsigned int)1, unigram_.Raw()[i]);
   }
@@ -271,18 +276,18 @@ template <class Value> template <class Build> void HashedSearch<Value>::ApplyBui
   try {
     if (counts.size() > 2) {
       ReadNGrams<Build, ActivateUnigram<typename Value::Weights>, Middle>(
-          f, 2, counts[1], vocab, build, unigram_.Raw(), middle_, ActivateUnigram<typename Value::Weights>(unigram_.Raw()), middle_[0], warn);
+          f, 2, counts[1], vocab, build, unigram_.Raw(), middle_, ActivateUnigram<typename Value::Weights>(unigram_.Raw()), middle_[0], warn, config.building_threads);
     }
     for (unsigned int n = 3; n < counts.size(); ++n) {
       ReadNGrams<Build, ActivateLowerMiddle<Middle>, Middle>(
-          f, n, counts[n-1], vocab, build, unigram_.Raw(), middle_, ActivateLowerMiddle<Middle>(middle_[n-3]), middle_[n-2], warn);
+          f, n, counts[n-1], vocab, build, unigram_.Raw(), middle_, ActivateLowerMiddle<Middle>(middle_[n-3]), middle_[n-2], warn, config.building_threads);
     }
     if (counts.size() > 2) {
       ReadNGrams<Build, ActivateLowerMiddle<Middle>, Longest>(
-          f, counts.size(), counts[counts.size() - 1], vocab, build, unigram_.Raw(), middle_, ActivateLowerMiddle<Middle>(middle_.back()), longest_, warn);
+          f, counts.size(), counts[counts.size() - 1], vocab, build, unigram_.Raw(), middle_, ActivateLowerMiddle<Middle>(middle_.back()), longest_, warn, config.building_threads);
     } else {
       ReadNGrams<Build, ActivateUnigram<typename Value::Weights>, Longest>(
-          f, counts.size(), counts[counts.size() - 1], vocab, build, unigram_.Raw(), middle_, ActivateUnigram<typename Value::Weights>(unigram_.Raw()), longest_, warn);
+          f, counts.size(), counts[counts.size() - 1], vocab, build, unigram_.Raw(), middle_, ActivateUnigram<typename Value::Weights>(unigram_.Raw()), longest_, warn, config.building_threads);
     }
   } catch (util::ProbingSizeException &e) {
     UTIL_THROW(util::ProbingSizeException, "Avoid pruning n-grams like \"bar baz quux\" when \"foo bar baz quux\" is still in the model.  KenLM will work when this pruning happens, but the probing model assumes these events are rare enough that using blank space in the probing hash table will cover all of them.  Increase probing_multiplier (-p to build_binary) to add more blank spaces.\n");
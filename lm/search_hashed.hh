@@ -118,6 +118,21 @@ template <class Value> class HashedSearch {
       return ret;
     }
 
+    // Prefetch the entries that scoring new_word after the context
+    // [context_rbegin, context_rend) will probe.
+    void Prefetch(WordIndex new_word, const WordIndex *context_rbegin, const WordIndex *context_rend) const {
+      unigram_.Prefetch(new_word);
+      Node node = static_cast<Node>(new_word);
+      for (unsigned char order_minus_2 = 0; context_rbegin != context_rend; ++context_rbegin, ++order_minus_2) {
+        node = CombineWordHash(node, *context_rbegin);
+        if (order_minus_2 == middle_.size()) {
+          longest_.Prefetch(node);
+          return;
+        }
+        middle_[order_minus_2].Prefetch(node);
+      }
+    }
+
     LongestPointer LookupLongest(WordIndex word, const Node &node) const {
       // Sign bit is always on because longest n-grams do not extend left.
       typename Longest::ConstIterator found;
@@ -140,7 +155,7 @@ template <class Value> class HashedSearch {
     // Interpret config's rest cost build policy and pass the right template argument to ApplyBuild.
     void DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
 
-    template <class Build> void ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
+    template <class Build> void ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
 
     class Unigram {
       public:
@@ -164,6 +179,12 @@ template <class Value> class HashedSearch {
           return unigram_[index];
         }
 
+        void Prefetch(WordIndex index) const {
+#if defined(__GNUC__)
+          __builtin_prefetch(unigram_ + index);
+#endif
+        }
+
         typename Value::Weights &Unknown() { return unigram_[0]; }
 
         // For building.
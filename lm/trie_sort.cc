@@ -2,6 +2,7 @@
 
 #include "lm/config.hh"
 #include "lm/lm_exception.hh"
+#include "lm/parallel_read_arpa.hh"
 #include "lm/read_arpa.hh"
 #include "lm/vocab.hh"
 #include "lm/weights.hh"
@@ -9,8 +10,14 @@
 #include "util/file_piece.hh"
 #include "util/mmap.hh"
 #include "util/proxy_iterator.hh"
+#include "util/scoped.hh"
 #include "util/sized_iterator.hh"
 
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#endif
+
 #include <algorithm>
 #include <cstring>
 #include <cstdio>
@@ -150,6 +157,98 @@ template <class Combine> FILE *MergeSortedFiles(FILE *first_file, FILE *second_f
   return out_file.release();
 }
 
+// Runs every task, each on its own thread if there are several.  Tasks catch
+// their own exceptions.
+template <class Task> void RunAll(std::vector<Task> &tasks) {
+#ifdef WITH_THREADS
+  if (tasks.size() > 1) {
+    boost::thread_group threads;
+    for (std::size_t i = 1; i < tasks.size(); ++i) {
+      threads.create_thread(boost::bind(&Task::operator(), &tasks[i]));
+    }
+    tasks[0]();
+    threads.join_all();
+    return;
+  }
+#endif
+  for (std::size_t i = 0; i < tasks.size(); ++i) {
+    tasks[i]();
+  }
+}
+
+// Sorts part of a batch and writes it and its contexts to temporary files.
+class SortPart {
+  public:
+    SortPart(uint8_t *begin, uint8_t *end, const std::string &temp_prefix, std::size_t entry_size, unsigned char order)
+      : begin_(begin), end_(end), temp_prefix_(&temp_prefix), entry_size_(entry_size), order_(order), full(NULL), context(NULL) {}
+
+    void operator()() {
+      try {
+        // Sort full records by full n-gram.
+        util::SizedProxy proxy_begin(begin_, entry_size_), proxy_end(end_, entry_size_);
+        // parallel_sort uses too much RAM.  TODO: figure out why windows sort doesn't like my proxies.
+#if defined(_WIN32) || defined(_WIN64)
+        std::stable_sort
+#else
+        std::sort
+#endif
+            (NGramIter(proxy_begin), NGramIter(proxy_end), util::SizedCompare<EntryCompare>(EntryCompare(order_)));
+        full = DiskFlush(begin_, end_, *temp_prefix_);
+        context = WriteContextFile(begin_, end_, *temp_prefix_, entry_size_, order_);
+      } catch (const std::exception &e) {
+        error = e.what();
+      }
+    }
+
+  private:
+    uint8_t *begin_, *end_;
+    const std::string *temp_prefix_;
+    std::size_t entry_size_;
+    unsigned char order_;
+
+  public:
+    FILE *full, *context;
+    std::string error;
+};
+
+// Merges two sorted files and their two context files.
+class MergePair {
+  public:
+    MergePair(FILE *first, FILE *second, FILE *first_context, FILE *second_context, const std::string &temp_prefix, std::size_t weights_size, unsigned char order)
+      : first_(first), second_(second), first_context_(first_context), second_context_(second_context),
+        temp_prefix_(&temp_prefix), weights_size_(weights_size), order_(order), full(NULL), context(NULL) {}
+
+    void operator()() {
+      try {
+        full = MergeSortedFiles(first_, second_, *temp_prefix_, weights_size_, order_, ThrowCombine());
+        context = MergeSortedFiles(first_context_, second_context_, *temp_prefix_, 0, order_ - 1, FirstCombine());
+      } catch (const std::exception &e) {
+        error = e.what();
+      }
+    }
+
+  private:
+    FILE *first_, *second_, *first_context_, *second_context_;
+    const std::string *temp_prefix_;
+    std::size_t weights_size_;
+    unsigned char order_;
+
+  public:
+    FILE *full, *context;
+    std::string error;
+};
+
+// Keep the output files of tasks, then throw if any failed.
+template <class Task> void CollectFiles(std::vector<Task> &tasks, std::deque<FILE*> &files, std::deque<FILE*> &contexts) {
+  std::string error;
+  for (typename std::vector<Task>::iterator i = tasks.begin(); i != tasks.end(); ++i) {
+    if (i->full) files.push_back(i->full);
+    if (i->context) contexts.push_back(i->context);
+    if (error.empty()) error = i->error;
+  }
+  UTIL_THROW_IF(!error.empty(), FormatLoadException, error);
+}
+
 } // namespace
 
 void RecordReader::Init(FILE *file, std::size_t entry_size) {
@@ -212,7 +311,7 @@ SortedFiles::SortedFiles(const Config &config, util::FilePiece &f, std::vector<u
   if (!mem.get()) UTIL_THROW(util::ErrnoException, "malloc failed for sort buffer size " << buffer);
 
   for (unsigned char order = 2; order <= counts.size(); ++order) {
-    ConvertToSorted(f, vocab, counts, file_prefix, order, warn, mem.get(), buffer);
+    ConvertToSorted(f, vocab, counts, file_prefix, order, warn, mem.get(), buffer, config.building_threads);
   }
   ReadEnd(f);
 }
@@ -237,8 +336,14 @@ class Closer {
 };
 } // namespace
 
-void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &file_prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size) {
+/* With threads, ARPA parsing is spread over them, each batch is sorted in
+ * that many parts at once, and pairs of files are merged at once.  Merging
+ * gives the same files whatever the order, so the output does not depend on
+ * the number of threads.
+ */
+void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &file_prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size, std::size_t threads) {
   ReadNGramHeader(f, order);
+  threads = std::max<std::size_t>(threads, 1);
   const size_t count = counts[order - 1];
   // Size of weights.  Does it include backoff?
   const size_t words_size = sizeof(WordIndex) * order;
@@ -250,44 +355,55 @@ void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vo
   std::deque<FILE*> files, contexts;
   Closer files_closer(files), contexts_closer(contexts);
 
+  util::scoped_ptr<NGramReader<SortedVocabulary, Prob> > longest;
+  util::scoped_ptr<NGramReader<SortedVocabulary, ProbBackoff> > middle;
+  if (order == counts.size()) {
+    longest.reset(new NGramReader<SortedVocabulary, Prob>(f, order, count, vocab, warn, threads));
+  } else {
+    middle.reset(new NGramReader<SortedVocabulary, ProbBackoff>(f, order, count, vocab, warn, threads));
+  }
+
   for (std::size_t batch = 0, done = 0; done < count; ++batch) {
     uint8_t *out = begin;
     uint8_t *out_end = out + std::min(count - done, batch_size) * entry_size;
     if (order == counts.size()) {
       for (; out != out_end; out += entry_size) {
         std::reverse_iterator<WordIndex*> it(reinterpret_cast<WordIndex*>(out) + order);
-        ReadNGram(f, order, vocab, it, *reinterpret_cast<Prob*>(out + words_size), warn);
+        longest->Read(it, *reinterpret_cast<Prob*>(out + words_size));
       }
     } else {
       for (; out != out_end; out += entry_size) {
         std::reverse_iterator<WordIndex*> it(reinterpret_cast<WordIndex*>(out) + order);
-        ReadNGram(f, order, vocab, it, *reinterpret_cast<ProbBackoff*>(out + words_size), warn);
+        middle->Read(it, *reinterpret_cast<ProbBackoff*>(out + words_size));
       }
     }
-    // Sort full records by full n-gram.
-    util::SizedProxy proxy_begin(begin, entry_size), proxy_end(out_end, entry_size);
-    // parallel_sort uses too much RAM.  TODO: figure out why windows sort doesn't like my proxies.
-#if defined(_WIN32) || defined(_WIN64)
-    std::stable_sort
-#else
-    std::sort
-#endif
-        (NGramIter(proxy_begin), NGramIter(proxy_end), util::SizedCompare<EntryCompare>(EntryCompare(order)));
-    files.push_back(DiskFlush(begin, out_end, file_prefix));
-    contexts.push_back(WriteContextFile(begin, out_end, file_prefix, entry_size, order));
+    const std::size_t entries = (out_end - begin) / entry_size;
+    const std::size_t parts = std::min(threads, entries);
+    std::vector<SortPart> sorts;
+    for (std::size_t part = 0; part < parts; ++part) {
+      sorts.push_back(SortPart(begin + entries * part / parts * entry_size, begin + entries * (part + 1) / parts * entry_size, file_prefix, entry_size, order));
+    }
+    RunAll(sorts);
+    CollectFiles(sorts, files, contexts);
 
-    done += (out_end - begin) / entry_size;
+    done += entries;
   }
 
   // All individual files created.  Merge them.
 
   while (files.size() > 1) {
-    files.push_back(MergeSortedFiles(files[0], files[1], file_prefix, weights_size, order, ThrowCombine()));
-    files_closer.PopFront();
-    files_closer.PopFront();
-    contexts.push_back(MergeSortedFiles(contexts[0], contexts[1], file_prefix, 0, order - 1, FirstCombine()));
-    contexts_closer.PopFront();
-    contexts_closer.PopFront();
+    std::vector<MergePair> merges;
+    for (std::size_t i = 0; i + 1 < files.size() && merges.size() < threads; i += 2) {
+      merges.push_back(MergePair(files[i], files[i + 1], contexts[i], contexts[i + 1], file_prefix, weights_size, order));
+    }
+    RunAll(merges);
+    for (std::size_t i = 0; i < merges.size(); ++i) {
+      files_closer.PopFront();
+      files_closer.PopFront();
+      contexts_closer.PopFront();
+      contexts_closer.PopFront();
+    }
+    CollectFiles(merges, files, contexts);
   }
 
   if (!files.empty()) {
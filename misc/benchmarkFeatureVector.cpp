@@ -0,0 +1,87 @@
+// Time the score vector operations done for every hypothesis: copying a
+// score breakdown, adding translation option and feature scores to it,
+// and the inner product with the weights.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "moses/FeatureVector.h"
+#include "util/usage.hh"
+
+void usage();
+
+using namespace Moses;
+
+int main(int argc, char **argv)
+{
+  int ncore = 20;
+  int nsparse = 0;
+  int repeat = 1000000;
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n")) {
+      if(i + 1 == argc)
+        usage();
+      ncore = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-s")) {
+      if(i + 1 == argc)
+        usage();
+      nsparse = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-r")) {
+      if(i + 1 == argc)
+        usage();
+      repeat = atoi(argv[++i]);
+    } else
+      usage();
+  }
+
+  if(ncore < 1 || nsparse < 0 || repeat < 1)
+    usage();
+
+  FVector weights(ncore), optionScores(ncore);
+  for(int i = 0; i < ncore; i++) {
+    weights[i] = 0.1 * (i + 1);
+    optionScores[i] = -0.5 * (i % 3);
+  }
+  for(int i = 0; i < nsparse; i++) {
+    std::stringstream name;
+    name << "sparse_" << i;
+    weights[FName(name.str())] = 0.01 * i;
+    optionScores[FName(name.str())] = 1;
+  }
+
+  double start = util::WallTime();
+  double total = 0;
+  FVector prev(ncore);
+  for(int r = 0; r < repeat; r++) {
+    // as in Hypothesis: new breakdown, option scores, a few features,
+    // then the weighted score
+    FVector breakdown(prev);
+    breakdown += optionScores;
+    breakdown[r % ncore] += 1.0;
+    breakdown[(r + 1) % ncore] -= 0.5;
+    total += breakdown.inner_product(weights);
+    if(r % 16 == 0)
+      prev = breakdown;
+  }
+  double seconds = util::WallTime() - start;
+
+  std::cout << "core=" << ncore
+            << " sparse=" << nsparse
+            << " hypotheses=" << repeat
+            << " seconds=" << seconds
+            << " hypotheses/s=" << (seconds > 0 ? repeat / seconds : 0)
+            << " checksum=" << total
+            << std::endl;
+}
+
+void usage()
+{
+  std::cerr << 	"Usage: benchmarkFeatureVector [-n <core>] [-s <sparse>] [-r <repeat>]\n"
+            "-n <core>         number of dense features (default: 20)\n"
+            "-s <sparse>       number of sparse features (default: 0)\n"
+            "-r <repeat>       number of hypotheses scored (default: 1000000)\n";
+  exit(1);
+}
@@ -0,0 +1,102 @@
+// Time decoding of binary phrase tables.
+// Source phrases are read from stdin, one per line, and looked up
+// repeatedly with the decoding cache switched off.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "moses/TranslationModel/CompactPT/PhraseDictionaryCompact.h"
+#include "moses/Util.h"
+#include "moses/Phrase.h"
+#include "moses/Timer.h"
+#include "moses/parameters/AllOptions.h"
+
+void usage();
+
+using namespace Moses;
+
+int main(int argc, char **argv)
+{
+  int nscores = 4;
+  int repeat = 1;
+  std::string ttable = "";
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n")) {
+      if(i + 1 == argc)
+        usage();
+      nscores = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-t")) {
+      if(i + 1 == argc)
+        usage();
+      ttable = argv[++i];
+    } else if(!strcmp(argv[i], "-r")) {
+      if(i + 1 == argc)
+        usage();
+      repeat = atoi(argv[++i]);
+    } else
+      usage();
+  }
+
+  if(ttable == "")
+    usage();
+
+  std::vector<FactorType> input(1, 0);
+
+  std::stringstream ss;
+  ss << "PhraseDictionaryCompact input-factor=0 output-factor=0"
+     << " num-features=" << nscores
+     << " decoding-cache-size=0 path=" << ttable;
+  PhraseDictionaryCompact pdc(ss.str());
+  AllOptions::ptr opts(new AllOptions);
+
+  Timer timer;
+  timer.start();
+  pdc.Load(opts);
+  std::cerr << "Loaded " << ttable << " in " << timer.get_elapsed_time()
+            << " seconds" << std::endl;
+
+  std::vector<Phrase> sourcePhrases;
+  std::string line;
+  while(getline(std::cin, line)) {
+    Phrase sourcePhrase;
+    sourcePhrase.CreateFromString(Input, input, line, NULL);
+    sourcePhrases.push_back(sourcePhrase);
+  }
+
+  size_t numFound = 0, numTargetPhrases = 0;
+  timer.start();
+  for(int r = 0; r < repeat; r++) {
+    for(size_t i = 0; i < sourcePhrases.size(); i++) {
+      TargetPhraseVectorPtr decodedPhraseColl
+      = pdc.GetTargetPhraseCollectionRaw(sourcePhrases[i]);
+      if(decodedPhraseColl != NULL) {
+        numFound++;
+        numTargetPhrases += decodedPhraseColl->size();
+      }
+    }
+  }
+  double seconds = timer.get_elapsed_time();
+
+  size_t numLookups = sourcePhrases.size() * repeat;
+  std::cout << "lookups=" << numLookups
+            << " found=" << numFound
+            << " target-phrases=" << numTargetPhrases
+            << " seconds=" << seconds
+            << " lookups/s=" << (seconds > 0 ? numLookups / seconds : 0)
+            << " target-phrases/s=" << (seconds > 0 ? numTargetPhrases / seconds : 0)
+            << std::endl;
+}
+
+void usage()
+{
+  std::cerr << 	"Usage: benchmarkPhraseTableMin [-n <nscores>] [-r <repeat>] -t <ttable> < phrases\n"
+            "-n <nscores>      number of scores in phrase table (default: 4)\n"
+            "-r <repeat>       look up every phrase this many times (default: 1)\n"
+            "-t <ttable>       phrase table\n";
+  exit(1);
+}
@@ -0,0 +1,73 @@
+// Time needed to load a text phrase table into memory with several parsing
+// threads.  Run with -j 1 for the sequential loader.  Peak RSS is printed
+// too: the threads only add the batch being parsed, the table itself takes
+// the same memory as with the sequential loader.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "moses/TranslationModel/PhraseDictionaryMemory.h"
+#include "moses/parameters/AllOptions.h"
+#include "util/usage.hh"
+
+void usage();
+
+using namespace Moses;
+
+int main(int argc, char **argv)
+{
+  int nscores = 4;
+  int threads = 1;
+  std::string ttable = "";
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n")) {
+      if(i + 1 == argc)
+        usage();
+      nscores = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-t")) {
+      if(i + 1 == argc)
+        usage();
+      ttable = argv[++i];
+    } else if(!strcmp(argv[i], "-j")) {
+      if(i + 1 == argc)
+        usage();
+      threads = atoi(argv[++i]);
+    } else
+      usage();
+  }
+
+  if(ttable == "" || threads < 1)
+    usage();
+
+  std::stringstream ss;
+  ss << "PhraseDictionaryMemory input-factor=0 output-factor=0"
+     << " num-features=" << nscores
+     << " load-threads=" << threads
+     << " path=" << ttable;
+  PhraseDictionaryMemory pdm(ss.str());
+  AllOptions::ptr opts(new AllOptions);
+
+  double rssBefore = util::RSSMax();
+  double start = util::WallTime();
+  pdm.Load(opts);
+  double seconds = util::WallTime() - start;
+
+  std::cout << "threads=" << threads
+            << " seconds=" << seconds
+            << " rss-max-mb=" << (util::RSSMax() / (1024.0 * 1024.0))
+            << " rss-growth-mb=" << ((util::RSSMax() - rssBefore) / (1024.0 * 1024.0))
+            << std::endl;
+}
+
+void usage()
+{
+  std::cerr << 	"Usage: benchmarkRuleTableLoad [-n <nscores>] [-j <threads>] -t <ttable>\n"
+            "-n <nscores>      number of scores in phrase table (default: 4)\n"
+            "-j <threads>      threads parsing the table (default: 1)\n"
+            "-t <ttable>       text phrase table, may be gzipped\n";
+  exit(1);
+}
@@ -0,0 +1,184 @@
+// vim:tabstop=2
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <cstdlib>
+#include <new>
+
+#ifdef WITH_THREADS
+#include <boost/thread/tss.hpp>
+#endif
+
+#include "Arena.h"
+
+namespace Moses
+{
+
+namespace
+{
+
+#ifdef WITH_THREADS
+// the scope owns nothing. Don't delete on thread exit
+void NoCleanup(Arena *)
+{
+}
+
+boost::thread_specific_ptr<Arena> s_current(NoCleanup);
+#else
+Arena *s_current = NULL;
+#endif
+
+// in front of every ArenaAllocated object. Padded to keep objects aligned
+union Header {
+  struct {
+    Arena *arena; // NULL if from the heap
+    size_t size;
+  } info;
+  char pad[16];
+};
+
+}
+
+Arena::Arena()
+  :m_current(NULL)
+  ,m_end(NULL)
+  ,m_blockSize(MIN_BLOCK)
+  ,m_size(0)
+{
+  for (size_t i = 0; i <= MAX_SIZE / ALIGN; ++i) {
+    m_free[i] = NULL;
+  }
+}
+
+Arena::~Arena()
+{
+  for (size_t i = 0; i < m_blocks.size(); ++i) {
+    free(m_blocks[i]);
+  }
+}
+
+void *Arena::Allocate(size_t size)
+{
+  size = (size + ALIGN - 1) & ~(ALIGN - 1);
+  if (size <= MAX_SIZE) {
+    FreeNode *&head = m_free[size / ALIGN];
+    if (head) {
+      void *ret = head;
+      head = head->next;
+      return ret;
+    }
+  }
+
+  if (m_current + size > m_end) {
+    while (m_blockSize < size) {
+      m_blockSize *= 2;
+    }
+    char *block = static_cast<char*>(malloc(m_blockSize));
+    if (block == NULL) {
+      throw std::bad_alloc();
+    }
+    m_blocks.push_back(block);
+    m_size += m_blockSize;
+    m_current = block;
+    m_end = block + m_blockSize;
+    if (m_blockSize < MAX_BLOCK) {
+      m_blockSize *= 2;
+    }
+  }
+
+  void *ret = m_current;
+  m_current += size;
+  return ret;
+}
+
+void Arena::Free(void *p, size_t size)
+{
+  size = (size + ALIGN - 1) & ~(ALIGN - 1);
+  if (size <= MAX_SIZE) {
+    FreeNode *node = static_cast<FreeNode*>(p);
+    node->next = m_free[size / ALIGN];
+    m_free[size / ALIGN] = node;
+  }
+}
+
+Arena *Arena::Current()
+{
+#ifdef WITH_THREADS
+  return s_current.get();
+#else
+  return s_current;
+#endif
+}
+
+void Arena::SetCurrent(Arena *arena)
+{
+#ifdef WITH_THREADS
+  s_current.reset(arena);
+#else
+  s_current = arena;
+#endif
+}
+
+Arena::Scope::Scope(Arena &arena)
+  :m_prev(Arena::Current())
+{
+  SetCurrent(&arena);
+}
+
+Arena::Scope::~Scope()
+{
+  SetCurrent(m_prev);
+}
+
+void *ArenaAllocated::operator new(size_t size)
+{
+  Arena *arena = Arena::Current();
+  size_t total = sizeof(Header) + size;
+
+  Header *header;
+  if (arena) {
+    header = static_cast<Header*>(arena->Allocate(total));
+  } else {
+    header = static_cast<Header*>(malloc(total));
+    if (header == NULL) {
+      throw std::bad_alloc();
+    }
+  }
+
+  header->info.arena = arena;
+  header->info.size = total;
+  return header + 1;
+}
+
+void ArenaAllocated::operator delete(void *p)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  Header *header = static_cast<Header*>(p) - 1;
+  if (header->info.arena) {
+    header->info.arena->Free(header, header->info.size);
+  } else {
+    free(header);
+  }
+}
+
+}
@@ -0,0 +1,101 @@
+// -*- c++ -*-
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_Arena_h
+#define moses_Arena_h
+
+#include <cstddef>
+#include <vector>
+
+namespace Moses
+{
+
+/** Memory for the objects created while decoding one sentence.
+  * Owned by the Manager and handed out in blocks, so decoding threads
+  * don't fight over the malloc arenas and the memory goes back in one
+  * step when the Manager is deleted. Objects deleted during search are
+  * recycled through free lists of the same size.
+  * Not thread-safe: an arena is only used by the thread decoding its sentence.
+  **/
+class Arena
+{
+public:
+  Arena();
+  ~Arena();
+
+  void *Allocate(size_t size);
+  void Free(void *p, size_t size);
+
+  //! bytes taken from the heap
+  size_t GetSize() const {
+    return m_size;
+  }
+
+  //! arena of the sentence being decoded by this thread, or NULL
+  static Arena *Current();
+
+  /** Makes an arena current for this thread, for as long as the scope lives */
+  class Scope
+  {
+  public:
+    Scope(Arena &arena);
+    ~Scope();
+  protected:
+    Arena *m_prev;
+  };
+
+protected:
+  static const size_t ALIGN = 16;
+  static const size_t MAX_SIZE = 4096; // bigger objects aren't recycled when freed
+  static const size_t MIN_BLOCK = 64 * 1024;
+  static const size_t MAX_BLOCK = 1024 * 1024;
+
+  std::vector<char*> m_blocks;
+  char *m_current, *m_end;
+  size_t m_blockSize, m_size;
+
+  struct FreeNode {
+    FreeNode *next;
+  };
+  FreeNode *m_free[MAX_SIZE / ALIGN + 1];
+
+  static void SetCurrent(Arena *arena);
+
+  // no copying
+  Arena(const Arena &);
+  Arena &operator=(const Arena &);
+};
+
+/** Base for classes whose objects are created in large numbers while
+  * decoding. new takes memory from the current arena if there is one,
+  * otherwise from the heap. Objects may be deleted as usual, but not after
+  * the arena they came from has gone.
+  **/
+class ArenaAllocated
+{
+public:
+  static void *operator new(size_t size);
+  static void operator delete(void *p);
+};
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <vector>
+
+#include "Arena.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+bool IsAligned(const void *p)
+{
+  return reinterpret_cast<size_t>(p) % 16 == 0;
+}
+
+struct Allocated : public ArenaAllocated {
+  char data[24];
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE(arena)
+
+BOOST_AUTO_TEST_CASE(free_reuse)
+{
+  Arena arena;
+  void *p = arena.Allocate(40);
+  void *other = arena.Allocate(40);
+  BOOST_CHECK(p != other);
+
+  // sizes are rounded up to 16 bytes, so 40 and 48 share a free list
+  arena.Free(p, 40);
+  BOOST_CHECK_EQUAL(arena.Allocate(48), p);
+  BOOST_CHECK(arena.Allocate(40) != p);
+
+  // last in, first out
+  arena.Free(p, 40);
+  arena.Free(other, 40);
+  BOOST_CHECK_EQUAL(arena.Allocate(40), other);
+  BOOST_CHECK_EQUAL(arena.Allocate(40), p);
+
+  // a different size doesn't take from this list
+  arena.Free(p, 40);
+  BOOST_CHECK(arena.Allocate(64) != p);
+  BOOST_CHECK_EQUAL(arena.Allocate(33), p);
+}
+
+BOOST_AUTO_TEST_CASE(large_objects)
+{
+  Arena arena;
+  size_t size = 100 * 1024;
+  char *p = static_cast<char*>(arena.Allocate(size));
+  memset(p, 1, size);
+  BOOST_CHECK(arena.GetSize() >= size);
+
+  // too big for the free lists
+  arena.Free(p, size);
+  char *q = static_cast<char*>(arena.Allocate(size));
+  BOOST_CHECK(q != p);
+  memset(q, 2, size);
+  BOOST_CHECK_EQUAL(p[0], 1);
+}
+
+BOOST_AUTO_TEST_CASE(alignment)
+{
+  Arena arena;
+  const size_t sizes[] = { 1, 3, 8, 17, 100, 4095, 5000, 70000 };
+  for (size_t round = 0; round < 100; ++round) {
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+      void *p = arena.Allocate(sizes[i]);
+      BOOST_CHECK(IsAligned(p));
+      if (round % 2) {
+        arena.Free(p, sizes[i]);
+      }
+    }
+  }
+
+  Arena::Scope scope(arena);
+  vector<Allocated*> objs;
+  for (size_t i = 0; i < 100; ++i) {
+    objs.push_back(new Allocated());
+    BOOST_CHECK(IsAligned(objs.back()));
+  }
+  for (size_t i = 0; i < objs.size(); ++i) {
+    delete objs[i];
+  }
+}
+
+BOOST_AUTO_TEST_CASE(scope)
+{
+  BOOST_CHECK(Arena::Current() == NULL);
+  Arena outer, inner;
+  {
+    Arena::Scope outerScope(outer);
+    BOOST_CHECK_EQUAL(Arena::Current(), &outer);
+    {
+      Arena::Scope innerScope(inner);
+      BOOST_CHECK_EQUAL(Arena::Current(), &inner);
+    }
+    BOOST_CHECK_EQUAL(Arena::Current(), &outer);
+  }
+  BOOST_CHECK(Arena::Current() == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(arena_allocated)
+{
+  // from the heap when no arena is current
+  Allocated *heap = new Allocated();
+  delete heap;
+
+  Arena arena;
+  Allocated *obj;
+  {
+    Arena::Scope scope(arena);
+    obj = new Allocated();
+  }
+  BOOST_CHECK(arena.GetSize() > 0);
+
+  // deleted outside the scope, the memory still goes back to its arena
+  delete obj;
+  {
+    Arena::Scope scope(arena);
+    Allocated *again = new Allocated();
+    BOOST_CHECK_EQUAL(again, obj);
+    delete again;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,6 +21,10 @@ DsgLM* ConstructDsgLM(const char *file)
       return new KenDsg<lm::ngram::ArrayTrieModel>(file, config);
     case lm::ngram::QUANT_ARRAY_TRIE:
       return new KenDsg<lm::ngram::QuantArrayTrieModel>(file, config);
+    case lm::ngram::EF_TRIE:
+      return new KenDsg<lm::ngram::EliasFanoTrieModel>(file, config);
+    case lm::ngram::QUANT_EF_TRIE:
+      return new KenDsg<lm::ngram::QuantEliasFanoTrieModel>(file, config);
     default:
       UTIL_THROW2("Unrecognized kenlm model type " << model_type);
     }
@@ -162,11 +162,108 @@ bool FName::operator!=(const FName& rhs) const
   return ! (*this == rhs);
 }
 
+FCoreVector::FCoreVector(size_t size)
+  :m_size(0)
+  ,m_data(m_inline)
+{
+  resize(size);
+}
+
+FCoreVector::FCoreVector(const FCoreVector &other)
+  :m_size(0)
+  ,m_data(m_inline)
+{
+  *this = other;
+}
+
+FCoreVector &FCoreVector::operator=(const FCoreVector &other)
+{
+  if (this != &other) {
+    if (other.m_size != m_size) {
+      if (m_data != m_inline) delete [] m_data;
+      m_size = other.m_size;
+      m_data = m_size <= INLINE_SIZE ? m_inline : new FValue[m_size];
+    }
+    std::copy(other.m_data, other.m_data + m_size, m_data);
+  }
+  return *this;
+}
+
+void FCoreVector::resize(size_t size, FValue value)
+{
+  if (size != m_size) {
+    if (m_data != m_inline) delete [] m_data;
+    m_size = size;
+    m_data = m_size <= INLINE_SIZE ? m_inline : new FValue[m_size];
+  }
+  std::fill(m_data, m_data + m_size, value);
+}
+
+FValue FCoreVector::sum() const
+{
+  FValue ret = 0;
+  for (size_t i = 0; i < m_size; ++i) {
+    ret += m_data[i];
+  }
+  return ret;
+}
+
+FCoreVector &FCoreVector::operator*=(FValue rhs)
+{
+  for (size_t i = 0; i < m_size; ++i) {
+    m_data[i] *= rhs;
+  }
+  return *this;
+}
+
+FCoreVector &FCoreVector::operator/=(FValue rhs)
+{
+  for (size_t i = 0; i < m_size; ++i) {
+    m_data[i] /= rhs;
+  }
+  return *this;
+}
+
+void swap(FCoreVector &first, FCoreVector &second)
+{
+  if (first.m_data != first.m_inline && second.m_data != second.m_inline) {
+    std::swap(first.m_size, second.m_size);
+    std::swap(first.m_data, second.m_data);
+  } else {
+    FCoreVector tmp(first);
+    first = second;
+    second = tmp;
+  }
+}
+
+namespace
+{
+
+// dense kernels. Plain loops over the arrays, which the compiler can
+// vectorise. The inner product is left serial: it adds the terms in index
+// order onto sum, so scores come out the same to the last bit
+inline void DenseAdd(FValue *out, const FValue *in, size_t size)
+{
+  for (size_t i = 0; i < size; ++i) {
+    out[i] += in[i];
+  }
+}
+
+inline FValue DenseInnerProduct(FValue sum, const FValue *a, const FValue *b, size_t size)
+{
+  for (size_t i = 0; i < size; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+}
+
 FVector::FVector(size_t coreFeatures) : m_coreFeatures(coreFeatures) {}
 
 void FVector::resize(size_t newsize)
 {
-  valarray<FValue> oldValues(m_coreFeatures);
+  FCoreVector oldValues(m_coreFeatures);
   m_coreFeatures.resize(newsize);
   for (size_t i = 0; i < min(m_coreFeatures.size(), oldValues.size()); ++i) {
     m_coreFeatures[i] = oldValues[i];
@@ -262,23 +359,11 @@ ProxyFVector FVector::operator[](const FName& name)
   return ProxyFVector(this, name);
 }
 
-/** Equivalent for core features. */
-FValue& FVector::operator[](size_t index)
-{
-  return m_coreFeatures[index];
-}
-
-
 FValue FVector::operator[](const FName& name) const
 {
   return get(name);
 }
 
-FValue FVector::operator[](size_t index) const
-{
-  return m_coreFeatures[index];
-}
-
 ostream& FVector::print(ostream& out) const
 {
   out << "core=(";
@@ -370,10 +455,11 @@ FVector& FVector::operator+= (const FVector& rhs)
 {
   if (rhs.m_coreFeatures.size() > m_coreFeatures.size())
     resize(rhs.m_coreFeatures.size());
-  for (const_iterator i = rhs.cbegin(); i != rhs.cend(); ++i)
-    set(i->first, get(i->first) + i->second);
-  for (size_t i = 0; i < rhs.m_coreFeatures.size(); ++i)
-    m_coreFeatures[i] += rhs.m_coreFeatures[i];
+  if (!rhs.m_features.empty()) {
+    for (const_iterator i = rhs.cbegin(); i != rhs.cend(); ++i)
+      set(i->first, get(i->first) + i->second);
+  }
+  DenseAdd(m_coreFeatures.data(), rhs.m_coreFeatures.data(), rhs.m_coreFeatures.size());
   return *this;
 }
 
@@ -389,8 +475,7 @@ void FVector::corePlusEquals(const FVector& rhs)
 {
   if (rhs.m_coreFeatures.size() > m_coreFeatures.size())
     resize(rhs.m_coreFeatures.size());
-  for (size_t i = 0; i < rhs.m_coreFeatures.size(); ++i)
-    m_coreFeatures[i] += rhs.m_coreFeatures[i];
+  DenseAdd(m_coreFeatures.data(), rhs.m_coreFeatures.data(), rhs.m_coreFeatures.size());
 }
 
 // assign only core features
@@ -806,13 +891,12 @@ FValue FVector::inner_product(const FVector& rhs) const
 {
   assert(m_coreFeatures.size() == rhs.m_coreFeatures.size());
   FValue product = 0.0;
-  for (const_iterator i = cbegin(); i != cend(); ++i) {
-    product += ((i->second)*(rhs.get(i->first)));
-  }
-  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
-    product += m_coreFeatures[i]*rhs.m_coreFeatures[i];
+  if (!m_features.empty()) {
+    for (const_iterator i = cbegin(); i != cend(); ++i) {
+      product += ((i->second)*(rhs.get(i->first)));
+    }
   }
-  return product;
+  return DenseInnerProduct(product, m_coreFeatures.data(), rhs.m_coreFeatures.data(), m_coreFeatures.size());
 }
 
 void FVector::merge(const FVector &other)
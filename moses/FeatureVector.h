@@ -22,11 +22,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef FEATUREVECTOR_H
 #define FEATUREVECTOR_H
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
-#include <valarray>
 #include <vector>
 
 #include <boost/functional/hash.hpp>
@@ -37,7 +37,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
-#include <boost/serialization/valarray.hpp>
 #endif
 
 #ifdef WITH_THREADS
@@ -121,6 +120,57 @@ struct FNameHash
 
 class ProxyFVector;
 
+/**
+ * The core (dense) part of a feature vector. Models with up to
+ * INLINE_SIZE dense features, i.e. nearly all of them, keep the values
+ * inside the object, so copying a score breakdown doesn't touch the heap.
+ **/
+class FCoreVector
+{
+public:
+  static const size_t INLINE_SIZE = 32;
+
+  explicit FCoreVector(size_t size = 0);
+  FCoreVector(const FCoreVector &other);
+  ~FCoreVector() {
+    if (m_data != m_inline) delete [] m_data;
+  }
+
+  FCoreVector &operator=(const FCoreVector &other);
+
+  size_t size() const {
+    return m_size;
+  }
+
+  FValue &operator[](size_t i) {
+    return m_data[i];
+  }
+  FValue operator[](size_t i) const {
+    return m_data[i];
+  }
+
+  FValue *data() {
+    return m_data;
+  }
+  const FValue *data() const {
+    return m_data;
+  }
+
+  //! as std::valarray: all values are set to value
+  void resize(size_t size, FValue value = 0);
+
+  FValue sum() const;
+  FCoreVector &operator*=(FValue rhs);
+  FCoreVector &operator/=(FValue rhs);
+
+  friend void swap(FCoreVector &first, FCoreVector &second);
+
+private:
+  size_t m_size;
+  FValue *m_data; // m_inline, or the heap if bigger
+  FValue m_inline[INLINE_SIZE];
+};
+
 /**
  * A sparse feature (or weight) vector.
  **/
@@ -171,9 +221,15 @@ public:
 
   /** Element access */
   ProxyFVector operator[](const FName& name);
-  FValue& operator[](size_t index);
   FValue operator[](const FName& name) const;
-  FValue operator[](size_t index) const;
+
+  /** Equivalent for core features. */
+  FValue& operator[](size_t index) {
+    return m_coreFeatures[index];
+  }
+  FValue operator[](size_t index) const {
+    return m_coreFeatures[index];
+  }
 
   /** Size */
   size_t size() const {
@@ -184,7 +240,7 @@ public:
     return m_coreFeatures.size();
   }
 
-  const std::valarray<FValue> &getCoreFeatures() const {
+  const FCoreVector &getCoreFeatures() const {
     return m_coreFeatures;
   }
 
@@ -273,7 +329,7 @@ private:
   void set(const FName& name, const FValue& value);
 
   FNVmap m_features;
-  std::valarray<FValue> m_coreFeatures;
+  FCoreVector m_coreFeatures;
 
 #ifdef MPI_ENABLE
   //serialization
@@ -287,9 +343,11 @@ private:
       names.push_back(ostr.str());
       values.push_back(i->second);
     }
+    std::vector<FValue> coreValues(m_coreFeatures.data(),
+                                   m_coreFeatures.data() + m_coreFeatures.size());
     ar << names;
     ar << values;
-    ar << m_coreFeatures;
+    ar << coreValues;
   }
 
   template<class Archive>
@@ -297,9 +355,12 @@ private:
     clear();
     std::vector<std::string> names;
     std::vector<FValue> values;
+    std::vector<FValue> coreValues;
     ar >> names;
     ar >> values;
-    ar >> m_coreFeatures;
+    ar >> coreValues;
+    m_coreFeatures.resize(coreValues.size());
+    std::copy(coreValues.begin(), coreValues.end(), m_coreFeatures.data());
     UTIL_THROW_IF2(names.size() != values.size(), "Error");
     for (size_t i = 0; i < names.size(); ++i) {
       set(FName(names[i]), values[i]);
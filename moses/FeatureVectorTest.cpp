@@ -306,6 +306,42 @@ BOOST_AUTO_TEST_CASE(ip)
   BOOST_CHECK_CLOSE((FValue)p1, 1.1*0.5 + -0.1*0.25 + 2.2*2.4, TOL);
 }
 
+BOOST_AUTO_TEST_CASE(core_sizes)
+{
+  // inline and heap storage of the core features
+  const size_t sizes[] = {7, FCoreVector::INLINE_SIZE + 9};
+  for (size_t s = 0; s < 2; ++s) {
+    size_t size = sizes[s];
+    FVector f1(size);
+    FVector f2(size);
+    FValue ip = 0;
+    for (size_t i = 0; i < size; ++i) {
+      f1[i] = i;
+      f2[i] = 0.5;
+      ip += i;
+    }
+
+    FVector f3(f1);
+    f3 += f2;
+    f3 += f1;
+    BOOST_CHECK_CLOSE((FValue)f3[size - 1], 2 * (size - 1) + 0.5, TOL);
+    BOOST_CHECK_CLOSE(inner_product(f3, f2), ip + 0.25 * size, TOL);
+
+    f3.resize(size + 3);
+    BOOST_CHECK_EQUAL(f3.coreSize(), size + 3);
+    BOOST_CHECK_CLOSE((FValue)f3[1], 2.5, TOL);
+    BOOST_CHECK_EQUAL(f3[size + 2], 0);
+
+    FVector f4(2);
+    f4[1] = -1;
+    swap(f3, f4);
+    BOOST_CHECK_EQUAL(f3.coreSize(), 2);
+    BOOST_CHECK_EQUAL(f3[1], -1);
+    BOOST_CHECK_EQUAL(f4.coreSize(), size + 3);
+    BOOST_CHECK_CLOSE((FValue)f4[1], 2.5, TOL);
+  }
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
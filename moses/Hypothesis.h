@@ -36,6 +36,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ScoreComponentCollection.h"
 #include "InputType.h"
 #include "ObjectPool.h"
+#include "Arena.h"
 #include "xmlrpc-c.h"
 
 namespace Moses
@@ -62,7 +63,7 @@ typedef std::vector<Hypothesis*> ArcList;
 		The expansion of hypotheses is handled in the class Manager, which
     stores active hypothesis in the search in hypothesis stacks.
 ***/
-class Hypothesis
+class Hypothesis : public ArenaAllocated
 {
   friend std::ostream& operator<<(std::ostream&, const Hypothesis&);
 protected:
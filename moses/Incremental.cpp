@@ -288,6 +288,8 @@ template void Manager::LMCallback<lm::ngram::TrieModel>(const lm::ngram::TrieMod
 template void Manager::LMCallback<lm::ngram::QuantTrieModel>(const lm::ngram::QuantTrieModel &model, const std::vector<lm::WordIndex> &words);
 template void Manager::LMCallback<lm::ngram::ArrayTrieModel>(const lm::ngram::ArrayTrieModel &model, const std::vector<lm::WordIndex> &words);
 template void Manager::LMCallback<lm::ngram::QuantArrayTrieModel>(const lm::ngram::QuantArrayTrieModel &model, const std::vector<lm::WordIndex> &words);
+template void Manager::LMCallback<lm::ngram::EliasFanoTrieModel>(const lm::ngram::EliasFanoTrieModel &model, const std::vector<lm::WordIndex> &words);
+template void Manager::LMCallback<lm::ngram::QuantEliasFanoTrieModel>(const lm::ngram::QuantEliasFanoTrieModel &model, const std::vector<lm::WordIndex> &words);
 
 void Manager::Decode()
 {
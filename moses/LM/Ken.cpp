@@ -425,6 +425,8 @@ template class LanguageModelKen<lm::ngram::TrieModel>;
 template class LanguageModelKen<lm::ngram::ArrayTrieModel>;
 template class LanguageModelKen<lm::ngram::QuantTrieModel>;
 template class LanguageModelKen<lm::ngram::QuantArrayTrieModel>;
+template class LanguageModelKen<lm::ngram::EliasFanoTrieModel>;
+template class LanguageModelKen<lm::ngram::QuantEliasFanoTrieModel>;
 
 
 LanguageModel *ConstructKenLM(const std::string &lineOrig)
@@ -500,6 +502,10 @@ LanguageModel *ConstructKenLM(const std::string &line, const std::string &file,
       return new LanguageModelKen<lm::ngram::ArrayTrieModel>(line, file, factorType, load_method);
     case lm::ngram::QUANT_ARRAY_TRIE:
       return new LanguageModelKen<lm::ngram::QuantArrayTrieModel>(line, file, factorType, load_method);
+    case lm::ngram::EF_TRIE:
+      return new LanguageModelKen<lm::ngram::EliasFanoTrieModel>(line, file, factorType, load_method);
+    case lm::ngram::QUANT_EF_TRIE:
+      return new LanguageModelKen<lm::ngram::QuantEliasFanoTrieModel>(line, file, factorType, load_method);
     default:
       UTIL_THROW2("Unrecognized kenlm model type " << model_type);
     }
@@ -100,6 +100,10 @@ LanguageModel *ConstructReloadingLM(const std::string &line, const std::string &
       return new ReloadingLanguageModel<lm::ngram::ArrayTrieModel>(line, file, factorType, lazy);
     case lm::ngram::QUANT_ARRAY_TRIE:
       return new ReloadingLanguageModel<lm::ngram::QuantArrayTrieModel>(line, file, factorType, lazy);
+    case lm::ngram::EF_TRIE:
+      return new ReloadingLanguageModel<lm::ngram::EliasFanoTrieModel>(line, file, factorType, lazy);
+    case lm::ngram::QUANT_EF_TRIE:
+      return new ReloadingLanguageModel<lm::ngram::QuantEliasFanoTrieModel>(line, file, factorType, lazy);
     default:
       UTIL_THROW2("Unrecognized kenlm model type " << model_type);
     }
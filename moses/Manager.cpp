@@ -91,6 +91,8 @@ Manager::~Manager()
 {
   delete m_transOptColl;
   delete m_search;
+  VERBOSE(2, "Line " << m_source.GetTranslationId() << ": Arena held "
+          << m_arena.GetSize() << " bytes" << endl);
   StaticData::Instance().CleanUpAfterSentenceProcessing(m_ttask.lock());
 }
 
@@ -106,6 +108,7 @@ Manager::GetSource() const
  */
 void Manager::Decode()
 {
+  Arena::Scope arenaScope(m_arena);
 
   //std::cerr << options().nbest.nbest_size << " "
   //          << options().nbest.enabled << " " << std::endl;
@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Search.h"
 #include "SearchCubePruning.h"
 #include "BaseManager.h"
+#include "Arena.h"
 
 namespace Moses
 {
@@ -112,6 +113,7 @@ private:
 
 protected:
   // data
+  Arena m_arena; /**< translation options, hypotheses and their states */
   TranslationOptionCollection *m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
   Search *m_search;
 
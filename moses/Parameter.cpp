@@ -59,7 +59,7 @@ Parameter::Parameter()
   AddParam(main_opts,"version", "show version of Moses and libraries used");
   AddParam(main_opts,"show-weights", "print feature weights and exit");
   AddParam(main_opts,"time-out", "seconds after which is interrupted (-1=no time-out, default is -1)");
-  AddParam(main_opts,"segment-time-out", "seconds for single segment after which is interrupted (-1=no time-out, default is -1)");
+  AddParam(main_opts,"segment-time-out", "seconds (fractions allowed) for single segment after which is interrupted (-1=no time-out, default is -1)");
 
   ///////////////////////////////////////////////////////////////////////////////////////
   // factorization options
@@ -87,6 +87,7 @@ Parameter::Parameter()
   AddParam(search_opts,"early-discarding-threshold", "edt", "threshold for constructing hypotheses based on estimate cost");
   AddParam(search_opts,"stack", "s", "maximum stack size for histogram pruning. 0 = unlimited stack size");
   AddParam(search_opts,"stack-diversity", "sd", "minimum number of hypothesis of each coverage in stack (default 0)");
+  AddParam(search_opts,"translation-option-threads", "number of threads building the translation options of a sentence (default 1)");
 
   // feature weight-related options
   AddParam(search_opts,"weight-file", "wf", "feature weights file. Do *not* put weights for 'core' features in here - they go in moses.ini");
@@ -234,6 +235,12 @@ Parameter::Parameter()
            "Max. number of seconds the server will keep a persistent connection alive.");
   AddParam(server_opts,"server-timeout",
            "Max. number of seconds the server will wait for a client to submit a request once a connection has been established.");
+  AddParam(server_opts,"server-max-queue",
+           "Max. No. of sentences queued or being translated. Requests beyond that are refused (default 0 = no limit).");
+  AddParam(server_opts,"server-request-timeout",
+           "Max. number of seconds from accepting a request to answering it, including time in the queue. The search is cut short to keep to it (default 0 = no limit).");
+  AddParam(server_opts,"server-result-timeout",
+           "Max. number of seconds the result of an async request is kept for the client to collect it (default 600, 0 = no limit).");
   // session timeout and session cache size are for moses translation session handling
   // they have nothing to do with the abyss server (but relate to the moses server)
   AddParam(server_opts,"session-timeout",
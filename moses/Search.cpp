@@ -34,7 +34,7 @@ out_of_time()
       return true;
     }
   }
-  int const& segment_timelimit = m_options.search.segment_timeout;
+  double const& segment_timelimit = m_options.search.segment_timeout;
   if (segment_timelimit > 0) {
     double elapsed_time = m_timer.get_elapsed_time();
     if (elapsed_time > segment_timelimit) {
@@ -0,0 +1,151 @@
+// vim:tabstop=2
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include "moses/TranslationModel/CacheColl.h"
+
+using namespace std;
+
+namespace Moses
+{
+
+CacheColl::CacheColl(size_t maxSize)
+{
+  SetMaxSize(maxSize);
+}
+
+void CacheColl::SetMaxSize(size_t maxSize)
+{
+  Clear();
+  m_maxSize = maxSize;
+  m_maxShardSize = (maxSize + NUM_SHARDS - 1) / NUM_SHARDS;
+}
+
+bool CacheColl::Find(size_t key, TargetPhraseCollection::shared_ptr &ret) const
+{
+  Shard &shard = GetShard(key);
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(shard.mutex);
+#endif
+  boost::unordered_map<size_t, size_t>::const_iterator iter = shard.index.find(key);
+  if (iter == shard.index.end()) {
+    ++shard.misses;
+    return false;
+  }
+
+  ++shard.hits;
+  Slot &slot = shard.slots[iter->second];
+  slot.referenced = true;
+  ret = slot.coll;
+  return true;
+}
+
+void CacheColl::Insert(size_t key, TargetPhraseCollection::shared_ptr coll)
+{
+  if (m_maxShardSize == 0) {
+    return;
+  }
+
+  Shard &shard = GetShard(key);
+  TargetPhraseCollection::shared_ptr evicted; // deleted after unlocking
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(shard.mutex);
+#endif
+  boost::unordered_map<size_t, size_t>::const_iterator iter = shard.index.find(key);
+  if (iter != shard.index.end()) {
+    // another thread got there first
+    Slot &slot = shard.slots[iter->second];
+    evicted = slot.coll;
+    slot.coll = coll;
+    return;
+  }
+
+  if (shard.slots.size() < m_maxShardSize) {
+    shard.index[key] = shard.slots.size();
+    Slot slot = { key, coll, false };
+    shard.slots.push_back(slot);
+    return;
+  }
+
+  // clock. Referenced entries get a 2nd chance
+  while (shard.slots[shard.hand].referenced) {
+    shard.slots[shard.hand].referenced = false;
+    shard.hand = (shard.hand + 1) % shard.slots.size();
+  }
+
+  Slot &slot = shard.slots[shard.hand];
+  shard.index.erase(slot.key);
+  evicted = slot.coll;
+  ++shard.evictions;
+
+  slot.key = key;
+  slot.coll = coll;
+  slot.referenced = false;
+  shard.index[key] = shard.hand;
+  shard.hand = (shard.hand + 1) % shard.slots.size();
+}
+
+void CacheColl::Clear()
+{
+  for (size_t i = 0; i < NUM_SHARDS; ++i) {
+    Shard &shard = m_shards[i];
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(shard.mutex);
+#endif
+    shard.index.clear();
+    shard.slots.clear();
+    shard.hand = 0;
+  }
+}
+
+size_t CacheColl::GetSize() const
+{
+  size_t ret = 0;
+  for (size_t i = 0; i < NUM_SHARDS; ++i) {
+    Shard &shard = m_shards[i];
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(shard.mutex);
+#endif
+    ret += shard.slots.size();
+  }
+  return ret;
+}
+
+void CacheColl::Debug(std::ostream &out) const
+{
+  size_t size = 0, hits = 0, misses = 0, evictions = 0;
+  for (size_t i = 0; i < NUM_SHARDS; ++i) {
+    Shard &shard = m_shards[i];
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(shard.mutex);
+#endif
+    size += shard.slots.size();
+    hits += shard.hits;
+    misses += shard.misses;
+    evictions += shard.evictions;
+  }
+
+  out << "size=" << size << "/" << m_maxSize
+      << " hits=" << hits
+      << " misses=" << misses
+      << " evictions=" << evictions;
+}
+
+}
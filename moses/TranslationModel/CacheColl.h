@@ -0,0 +1,97 @@
+// -*- c++ -*-
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_CacheColl_h
+#define moses_CacheColl_h
+
+#include <iostream>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
+#include "moses/TargetPhraseCollection.h"
+
+namespace Moses
+{
+
+/** Translations of source phrases already looked up in a phrase table,
+  * shared by all decoding threads. Keys are hashes of the source phrase
+  * (or anything else the phrase table identifies them by).
+  * Split into shards, each with its own lock, and bounded in size by
+  * CLOCK eviction. Cached collections must not be changed after Insert().
+  **/
+class CacheColl
+{
+public:
+  CacheColl(size_t maxSize);
+
+  //! maximum number of entries. 0 = don't cache
+  void SetMaxSize(size_t maxSize);
+  size_t GetMaxSize() const {
+    return m_maxSize;
+  }
+
+  //! true if cached. ret may be null if the phrase table had no translations
+  bool Find(size_t key, TargetPhraseCollection::shared_ptr &ret) const;
+
+  void Insert(size_t key, TargetPhraseCollection::shared_ptr coll);
+
+  void Clear();
+
+  size_t GetSize() const;
+  void Debug(std::ostream &out) const;
+
+protected:
+  struct Slot {
+    size_t key;
+    TargetPhraseCollection::shared_ptr coll;
+    bool referenced;
+  };
+
+  struct Shard {
+#ifdef WITH_THREADS
+    boost::mutex mutex;
+#endif
+    boost::unordered_map<size_t, size_t> index; // key -> slot
+    std::vector<Slot> slots;
+    size_t hand;
+
+    // stats
+    size_t hits, misses, evictions;
+
+    Shard() : hand(0), hits(0), misses(0), evictions(0) {
+    }
+  };
+
+  static const size_t NUM_SHARDS = 32;
+  size_t m_maxSize, m_maxShardSize;
+  mutable Shard m_shards[NUM_SHARDS];
+
+  Shard &GetShard(size_t key) const {
+    return m_shards[(key ^ (key >> 16)) % NUM_SHARDS];
+  }
+};
+
+}
+#endif
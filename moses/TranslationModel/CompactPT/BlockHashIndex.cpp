@@ -37,7 +37,7 @@ BlockHashIndex::BlockHashIndex(size_t orderBits, size_t fingerPrintBits,
   : m_orderBits(orderBits), m_fingerPrintBits(fingerPrintBits),
     m_fileHandle(0), m_fileHandleStart(0), m_landmarks(true), m_size(0),
     m_lastSaved(-1), m_lastDropped(-1), m_numLoadedRanges(0),
-    m_threadPool(threadsNum)
+    m_threadPool(threadsNum), m_numPending(0), m_maxPending(2 * threadsNum)
 {
 #ifndef HAVE_CMPH
   std::cerr << "minphr: CMPH support not compiled in." << std::endl;
@@ -211,6 +211,13 @@ void BlockHashIndex::WaitAll()
 {
   m_threadPool.Stop(true);
 }
+
+void BlockHashIndex::FinishTask()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_numPending--;
+  m_pendingDone.notify_all();
+}
 #endif
 
 size_t BlockHashIndex::FinalizeSave()
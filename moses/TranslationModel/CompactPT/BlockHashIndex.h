@@ -75,6 +75,12 @@ private:
   ThreadPool m_threadPool;
   boost::mutex m_mutex;
 
+  // blocks waiting for or being hashed. Each holds a copy of its keys, so
+  // AddRange blocks when too many are pending
+  size_t m_numPending;
+  size_t m_maxPending;
+  boost::condition_variable m_pendingDone;
+
   template <typename Keys>
   class HashTask : public Task
   {
@@ -83,7 +89,13 @@ private:
       : m_id(id), m_hash(hash), m_keys(new Keys(keys)) {}
 
     virtual void Run() {
-      m_hash.CalcHash(m_id, *m_keys);
+      try {
+        m_hash.CalcHash(m_id, *m_keys);
+      } catch(...) {
+        m_hash.FinishTask();
+        throw;
+      }
+      m_hash.FinishTask();
     }
 
     virtual ~HashTask() {
@@ -123,6 +135,7 @@ public:
 
 #ifdef WITH_THREADS
   void WaitAll();
+  void FinishTask();
 #endif
 
   void DropRange(size_t i);
@@ -162,6 +175,12 @@ public:
     }
 
 #ifdef WITH_THREADS
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      while(m_numPending >= m_maxPending)
+        m_pendingDone.wait(lock);
+      m_numPending++;
+    }
 
     boost::shared_ptr<HashTask<Keys> >
     ht(new HashTask<Keys>(current, *this, keys));
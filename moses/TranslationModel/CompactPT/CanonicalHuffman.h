@@ -24,8 +24,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <string>
 #include <algorithm>
+#include <stdint.h>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/unordered_map.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
 
 #include "ThrowingFwrite.h"
 
@@ -40,6 +42,13 @@ private:
   std::vector<size_t> m_firstCodes;
   std::vector<size_t> m_lengthIndex;
 
+  // Symbol position and code length for every possible LOOKUP_BITS bits
+  // at the front of the bit stream, so that short codes are decoded with one
+  // lookup. Stored as (position << 8) | length. For prefixes of longer codes
+  // the length is 0 and the prefix is stored instead of the position.
+  static const size_t LOOKUP_BITS = 10;
+  std::vector<size_t> m_lookup;
+
   typedef boost::unordered_map<Data, boost::dynamic_bitset<> > EncodeMap;
   EncodeMap m_encodeMap;
 
@@ -143,6 +152,35 @@ private:
     m_symbols.swap(t_symbols);
   }
 
+  void CreateLookupTable() {
+    m_lookup.clear();
+    m_lookup.resize(size_t(1) << LOOKUP_BITS, 0);
+
+    for(size_t l = 1; l < m_lengthIndex.size() && l <= LOOKUP_BITS; l++) {
+      size_t num = ((l+1 < m_lengthIndex.size()) ? m_lengthIndex[l+1]
+                    : m_symbols.size()) - m_lengthIndex[l];
+
+      for(size_t i = 0; i < num; i++) {
+        size_t entry = ((m_lengthIndex[l] + i) << 8) | l;
+        size_t streamBits = ReverseBits(m_firstCodes[l] + i, l);
+        for(size_t rest = 0; rest < (size_t(1) << (LOOKUP_BITS - l)); rest++)
+          m_lookup[streamBits | (rest << l)] = entry;
+      }
+    }
+
+    for(size_t streamBits = 0; streamBits < m_lookup.size(); streamBits++)
+      if(m_lookup[streamBits] == 0)
+        m_lookup[streamBits] = ReverseBits(streamBits, LOOKUP_BITS) << 8;
+  }
+
+  // codes are read most significant bit first, the stream is lsb first
+  static size_t ReverseBits(size_t bits, size_t length) {
+    size_t reversed = 0;
+    for(size_t j = 0; j < length; j++)
+      reversed |= ((bits >> (length - 1 - j)) & 1) << j;
+    return reversed;
+  }
+
   void CreateCodeMap() {
     for(size_t l = 1; l < m_lengthIndex.size(); l++) {
       size_t intCode = m_firstCodes[l];
@@ -177,6 +215,7 @@ public:
     std::vector<size_t> lengths;
     CalcLengths(begin, end, lengths);
     CalcCodes(lengths);
+    CreateLookupTable();
 
     if(forEncoding)
       CreateCodeMap();
@@ -196,7 +235,33 @@ public:
 
   template <class BitWrapper>
   Data Read(BitWrapper& bitWrapper) {
-    if(bitWrapper.TellFromEnd()) {
+    size_t bitsLeft = bitWrapper.TellFromEnd();
+    if(bitsLeft) {
+      size_t window = bitWrapper.Peek(32);
+      size_t entry = m_lookup[window & ((size_t(1) << LOOKUP_BITS) - 1)];
+      size_t length = entry & 0xFF;
+      if(length) {
+        if(length <= bitsLeft) {
+          bitWrapper.Skip(length);
+          return m_symbols[entry >> 8];
+        }
+      } else {
+        // longer code, continue from the looked up prefix
+        size_t intCode = entry >> 8;
+        size_t len = LOOKUP_BITS;
+        while(len < 32 && len < m_firstCodes.size()
+              && intCode < m_firstCodes[len]) {
+          intCode = 2 * intCode + ((window >> len) & 1);
+          len++;
+        }
+        if(len <= bitsLeft && len < m_firstCodes.size()
+            && intCode >= m_firstCodes[len]) {
+          bitWrapper.Skip(len);
+          return m_symbols[m_lengthIndex[len] + (intCode - m_firstCodes[len])];
+        }
+      }
+
+      // end of stream or very long code, read bit by bit
       size_t intCode = bitWrapper.Read();
       size_t len = 1;
       while(intCode < m_firstCodes[len]) {
@@ -225,6 +290,7 @@ public:
     m_lengthIndex.resize(size);
     read += std::fread(&m_lengthIndex[0], sizeof(size_t), size, pFile);
 
+    CreateLookupTable();
     return std::ftell(pFile) - start;
   }
 
@@ -288,6 +354,33 @@ public:
     m_bitPos++;
   }
 
+  // next bits (at most 32) without reading them, first bit lowest. Zero
+  // after the end
+  size_t Peek(size_t bits) const {
+    typedef typename boost::make_unsigned<typename Container::value_type>::type Value;
+    const size_t valueBits = sizeof(Value) * 8;
+
+    size_t index = m_bitPos / valueBits;
+    size_t offset = m_bitPos % valueBits;
+
+    uint64_t window = 0;
+    for(size_t shift = 0; shift < offset + bits && index < m_data.size();
+        shift += valueBits, index++)
+      window |= uint64_t(Value(m_data[index])) << shift;
+
+    return (window >> offset) & ((uint64_t(1) << bits) - 1);
+  }
+
+  // same as reading bits one by one
+  void Skip(size_t bits) {
+    const size_t valueBits = sizeof(typename Container::value_type) * 8;
+
+    m_bitPos += bits;
+    m_iterator = m_data.begin() + (m_bitPos - 1) / valueBits;
+    m_currentValue = (*m_iterator) >> ((m_bitPos - 1) % valueBits);
+    m_iterator++;
+  }
+
   size_t Tell() {
     return m_bitPos;
   }
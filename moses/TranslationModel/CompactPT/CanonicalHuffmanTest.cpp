@@ -0,0 +1,135 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util/exception.hh"
+#include "CanonicalHuffman.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+typedef map<unsigned int, size_t> Counts;
+
+// encodes symbols, then decodes them from the same bits
+void RoundTrip(const Counts &counts, const vector<unsigned int> &symbols)
+{
+  CanonicalHuffman<unsigned int> huffman(counts.begin(), counts.end());
+
+  string bits;
+  BitWrapper<> writer(bits);
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    huffman.Put(writer, symbols[i]);
+  }
+
+  BitWrapper<> reader(bits);
+  vector<unsigned int> decoded;
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    decoded.push_back(huffman.Read(reader));
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(decoded.begin(), decoded.end(),
+                                symbols.begin(), symbols.end());
+  BOOST_CHECK_EQUAL(reader.Tell(), writer.Tell());
+}
+
+vector<unsigned int> RandomSymbols(const Counts &counts, size_t size)
+{
+  vector<unsigned int> all;
+  for (Counts::const_iterator it = counts.begin(); it != counts.end(); ++it) {
+    all.push_back(it->first);
+  }
+  vector<unsigned int> symbols;
+  for (size_t i = 0; i < size; ++i) {
+    symbols.push_back(all[rand() % all.size()]);
+  }
+  return symbols;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(canonical_huffman)
+
+BOOST_AUTO_TEST_CASE(short_codes)
+{
+  // all codes fit in the lookup table
+  srand(42);
+  for (size_t round = 0; round < 50; ++round) {
+    Counts counts;
+    size_t numSymbols = 2 + rand() % 200;
+    for (size_t i = 0; i < numSymbols; ++i) {
+      counts[rand()] = 1 + rand() % 100;
+    }
+    RoundTrip(counts, RandomSymbols(counts, 1000));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(long_codes)
+{
+  // Fibonacci counts give a code one bit longer for every symbol, so most
+  // codes are longer than the lookup table and some longer than 32 bits
+  Counts counts;
+  size_t a = 1, b = 1;
+  for (unsigned int i = 0; i < 40; ++i) {
+    counts[i * 7] = a;
+    size_t next = a + b;
+    a = b;
+    b = next;
+  }
+  srand(43);
+  RoundTrip(counts, RandomSymbols(counts, 2000));
+
+  // a skewed alphabet: a few very frequent symbols and many rare ones
+  counts.clear();
+  for (unsigned int i = 0; i < 5000; ++i) {
+    counts[i] = i < 10 ? 1000000 : 1 + rand() % 3;
+  }
+  RoundTrip(counts, RandomSymbols(counts, 5000));
+}
+
+BOOST_AUTO_TEST_CASE(single_symbol)
+{
+  Counts counts;
+  counts[17] = 5;
+  RoundTrip(counts, vector<unsigned int>(100, 17));
+}
+
+BOOST_AUTO_TEST_CASE(end_of_stream)
+{
+  // the last codes end within the final byte, with fewer bits left than the
+  // lookup table reads
+  srand(44);
+  for (size_t round = 0; round < 100; ++round) {
+    Counts counts;
+    size_t numSymbols = 2 + rand() % 3000;
+    for (size_t i = 0; i < numSymbols; ++i) {
+      counts[i] = 1 + rand() % 1000;
+    }
+    RoundTrip(counts, RandomSymbols(counts, 1 + rand() % 20));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -25,6 +25,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cmath>
 #include <cassert>
 
+#include "util/exception.hh"
+
 namespace Moses
 {
 
@@ -250,70 +252,51 @@ private:
     outIt++;
   }
 
-  static inline size_t DecodeAndSumSymbol(uint input, size_t num, size_t &curr) {
-    uint type = (input >> 28);
+  static inline uint PopCount(uint x) {
+#ifdef __GNUC__
+    return __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    return (((x + (x >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+  }
 
-    uint bitlen = 0;
-    uint shift = 0;
-    uint mask = 0;
+  static inline size_t DecodeAndSumSymbol(uint input, size_t num, size_t &curr) {
+    // bits per number and numbers per word, by type
+    static const uint bitlens[] = { 0, 28, 14, 9, 7, 5, 4, 3, 2, 1 };
+    static const uint counts[]  = { 0, 1, 2, 3, 4, 5, 7, 9, 14, 28 };
+    // lowest bit of every number, for types with more numbers than bits
+    static const uint planes[]  = { 0, 0, 0, 0, 0, 0x108421, 0x1111111,
+                                    0x1249249, 0x5555555, 0xFFFFFFF
+                                  };
 
-    switch(type) {
-    case 1:
-      bitlen = 28;
-      shift = 0;
-      mask = 268435455;
-      break;
-    case 2:
-      bitlen = 14;
-      shift = 14;
-      mask = 16383;
-      break;
-    case 3:
-      bitlen = 9;
-      shift = 18;
-      mask = 511;
-      break;
-    case 4:
-      bitlen = 7;
-      shift = 21;
-      mask = 127;
-      break;
-    case 5:
-      bitlen = 5;
-      shift = 20;
-      mask = 31;
-      break;
-    case 6:
-      bitlen = 4;
-      shift = 24;
-      mask = 15;
-      break;
-    case 7:
-      bitlen = 3;
-      shift = 24;
-      mask = 7;
-      break;
-    case 8:
-      bitlen = 2;
-      shift = 26;
-      mask = 3;
-      break;
-    case 9:
-      bitlen = 1;
-      shift = 27;
-      mask = 1;
-      break;
+    uint type = (input >> 28);
+    UTIL_THROW_IF2(type >= sizeof(counts) / sizeof(counts[0]),
+                   "Corrupt Simple9 word with type " << type);
+    if(type == 0) {
+      // no payload, but it still takes a position, as it always did
+      curr++;
+      return 0;
     }
+    uint bitlen = bitlens[type];
+    uint count = counts[type];
 
     size_t sum = 0;
-    while(shift > 0) {
-      sum += (input >> shift) & mask;
-      shift -= bitlen;
+    if(planes[type] && curr + count <= num) {
+      // whole word is summed: add up bit planes instead of single numbers
+      for(uint j = 0; j < bitlen; j++)
+        sum += size_t(PopCount(input & (planes[type] << j))) << j;
+      curr += count;
+      return sum;
+    }
+
+    uint mask = (1u << bitlen) - 1;
+    for(uint i = count; i > 0; i--) {
+      sum += (input >> (bitlen * (i - 1))) & mask;
       if(++curr == num)
         return sum;
     }
-    sum += input & mask;
-    curr++;
     return sum;
   }
 
@@ -0,0 +1,147 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+#include "ListCoders.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+// numbers of mixed sizes, so that every Simple9 type is used. The encoder
+// can't take 0
+vector<unsigned int> RandomNumbers(size_t size)
+{
+  vector<unsigned int> numbers;
+  for (size_t i = 0; i < size; ++i) {
+    unsigned int bits = 1 + rand() % 27;
+    // mostly small numbers, like the phrase table's
+    if (rand() % 4) {
+      bits = 1 + rand() % 4;
+    }
+    numbers.push_back(1 + rand() % ((1u << bits) - 1));
+  }
+  return numbers;
+}
+
+size_t Sum(const vector<unsigned int> &numbers, size_t num)
+{
+  size_t sum = 0;
+  for (size_t i = 0; i < num; ++i) {
+    sum += numbers[i];
+  }
+  return sum;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(list_coders)
+
+BOOST_AUTO_TEST_CASE(simple9_round_trip)
+{
+  srand(1234);
+  for (size_t round = 0; round < 200; ++round) {
+    vector<unsigned int> numbers = RandomNumbers(1 + rand() % 200);
+
+    vector<unsigned int> encoded;
+    Simple9::Encode(numbers.begin(), numbers.end(), back_inserter(encoded));
+
+    vector<unsigned int> decoded;
+    vector<unsigned int>::iterator it = encoded.begin();
+    Simple9::Decode(it, encoded.end(), back_inserter(decoded));
+    BOOST_CHECK(it == encoded.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(decoded.begin(), decoded.end(),
+                                  numbers.begin(), numbers.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(simple9_decode_and_sum)
+{
+  srand(5678);
+  for (size_t round = 0; round < 200; ++round) {
+    vector<unsigned int> numbers = RandomNumbers(1 + rand() % 200);
+
+    vector<unsigned int> encoded;
+    Simple9::Encode(numbers.begin(), numbers.end(), back_inserter(encoded));
+
+    // any prefix, including ones that end inside a word
+    size_t num = 1 + rand() % numbers.size();
+    vector<unsigned int>::iterator it = encoded.begin();
+    BOOST_CHECK_EQUAL(Simple9::DecodeAndSum(it, encoded.end(), num),
+                      Sum(numbers, num));
+
+    // stops after the word holding the last number summed
+    vector<unsigned int> decoded;
+    vector<unsigned int>::iterator check = encoded.begin();
+    while (decoded.size() < num) {
+      Simple9::Decode(check, check + 1, back_inserter(decoded));
+    }
+    BOOST_CHECK(it == check);
+
+    // the whole list
+    it = encoded.begin();
+    BOOST_CHECK_EQUAL(Simple9::DecodeAndSum(it, encoded.end(), numbers.size()),
+                      Sum(numbers, numbers.size()));
+    BOOST_CHECK(it == encoded.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(simple9_type0)
+{
+  // type 0 words carry nothing but each takes a position
+  vector<unsigned int> words;
+  words.push_back(0);
+  words.push_back((1u << 28) | 5);          // type 1: 5
+  words.push_back(0);
+  words.push_back((2u << 28) | (3 << 14) | 4); // type 2: 3, 4
+
+  vector<unsigned int>::iterator it = words.begin();
+  BOOST_CHECK_EQUAL(Simple9::DecodeAndSum(it, words.end(), 1), 0);
+  BOOST_CHECK(it == words.begin() + 1);
+
+  it = words.begin();
+  BOOST_CHECK_EQUAL(Simple9::DecodeAndSum(it, words.end(), 3), 5);
+  BOOST_CHECK(it == words.begin() + 3);
+
+  it = words.begin();
+  BOOST_CHECK_EQUAL(Simple9::DecodeAndSum(it, words.end(), 4), 8);
+  BOOST_CHECK(it == words.end());
+
+  it = words.begin();
+  BOOST_CHECK_EQUAL(Simple9::DecodeAndSum(it, words.end(), 5), 12);
+  BOOST_CHECK(it == words.end());
+}
+
+BOOST_AUTO_TEST_CASE(simple9_corrupt_type)
+{
+  for (unsigned int type = 10; type < 16; ++type) {
+    vector<unsigned int> words(1, (type << 28) | 1);
+    vector<unsigned int>::iterator it = words.begin();
+    BOOST_CHECK_THROW(Simple9::DecodeAndSum(it, words.end(), 1), util::Exception);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -40,6 +40,8 @@ PhraseDecoder::PhraseDecoder(
     m_containsAlignmentInfo(true), m_maxRank(0),
     m_symbolTree(0), m_multipleScoreTrees(false),
     m_scoreTrees(1), m_alignTree(0),
+    m_decodingCache(phraseDictionary.m_decodingCacheSize,
+                    phraseDictionary.m_sharedDecodingCache),
     m_phraseDictionary(phraseDictionary), m_input(input), m_output(output),
     // m_weight(weight),
     m_separator(" ||| ")
@@ -454,9 +456,9 @@ TargetPhraseVectorPtr PhraseDecoder::DecodeCollection(
   return tpv;
 }
 
-void PhraseDecoder::PruneCache()
+void PhraseDecoder::DebugCache(std::ostream &out)
 {
-  m_decodingCache.Prune();
+  m_decodingCache.Debug(out);
 }
 
 }
@@ -136,7 +136,7 @@ public:
                                          bool topLevel,
                                          bool eval);
 
-  void PruneCache();
+  void DebugCache(std::ostream &out);
 };
 
 }
@@ -20,6 +20,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ***********************************************************************/
 
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <iterator>
 #include <queue>
@@ -50,6 +51,8 @@ PhraseDictionaryCompact::PhraseDictionaryCompact(const std::string &line)
   :PhraseDictionary(line, true)
   ,m_inMemory(s_inMemoryByDefault)
   ,m_useAlignmentInfo(true)
+  ,m_decodingCacheSize(5000)
+  ,m_sharedDecodingCache(false)
   ,m_hash(10, 16)
   ,m_phraseDecoder(0)
 {
@@ -177,12 +180,30 @@ CleanUpAfterSentenceProcessing(const InputType &source)
   if(!m_sentenceCache.get())
     m_sentenceCache.reset(new PhraseCache());
 
-  m_phraseDecoder->PruneCache();
   m_sentenceCache->clear();
 
+  IFVERBOSE(2) {
+    std::stringstream strme;
+    m_phraseDecoder->DebugCache(strme);
+    VERBOSE(2, GetScoreProducerDescription() << " decoding cache: " << strme.str() << std::endl);
+  }
+
   ReduceCache();
 }
 
+void
+PhraseDictionaryCompact::
+SetParameter(const std::string& key, const std::string& value)
+{
+  if (key == "decoding-cache-size") {
+    m_decodingCacheSize = Scan<size_t>(value);
+  } else if (key == "decoding-cache-shared") {
+    m_sharedDecodingCache = Scan<bool>(value);
+  } else {
+    PhraseDictionary::SetParameter(key, value);
+  }
+}
+
 bool PhraseDictionaryCompact::s_inMemoryByDefault = false;
 void
 PhraseDictionaryCompact::
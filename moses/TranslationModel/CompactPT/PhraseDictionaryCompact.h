@@ -51,6 +51,8 @@ protected:
   static bool s_inMemoryByDefault;
   bool m_inMemory;
   bool m_useAlignmentInfo;
+  size_t m_decodingCacheSize;
+  bool m_sharedDecodingCache;
 
   typedef std::vector<TargetPhraseCollection::shared_ptr > PhraseCache;
   typedef boost::thread_specific_ptr<PhraseCache> SentenceCache;
@@ -76,6 +78,7 @@ public:
 
   void CacheForCleanup(TargetPhraseCollection::shared_ptr  tpc);
   void CleanUpAfterSentenceProcessing(const InputType &source);
+  void SetParameter(const std::string& key, const std::string& value);
   static void SetStaticDefaultParameters(Parameter const& param);
 
   virtual ChartRuleLookupManager *CreateRuleLookupManager(
@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ConsistentPhrases.h"
 #include "ThrowingFwrite.h"
 #include "util/file.hh"
+#include "util/usage.hh"
 #include "util/exception.hh"
 
 namespace Moses
@@ -66,13 +67,13 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
     m_quantize(quantize), m_maxRank(maxRank),
 #ifdef WITH_THREADS
     m_threads(threads),
-    m_srcHash(m_orderBits, m_fingerPrintBits, 1),
+    m_srcHash(m_orderBits, m_fingerPrintBits, m_threads),
     m_rnkHash(10, 24, m_threads),
 #else
     m_srcHash(m_orderBits, m_fingerPrintBits),
     m_rnkHash(m_orderBits, m_fingerPrintBits),
 #endif
-    m_maxPhraseLength(0),
+    m_maxPhraseLength(0), m_passStart(util::WallTime()),
     m_lastFlushedLine(-1), m_lastFlushedSourceNum(0),
     m_lastFlushedSourcePhrase("")
 {
@@ -103,6 +104,7 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
   } else if(m_coding == PREnc) {
     std::cerr << "Pass " << cur_pass << "/" << all_passes << ": Creating hash function for rank assignment" << std::endl;
     cur_pass++;
+    m_passStart = util::WallTime();
     CreateRankHash();
   }
 
@@ -116,6 +118,7 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
   } else {
     m_encodedTargetPhrases = new StringVectorTemp<unsigned char, unsigned long, MmapAllocator>();
   }
+  m_passStart = util::WallTime();
   EncodeTargetPhrases();
 
   cur_pass++;
@@ -132,6 +135,7 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
   } else {
     m_compressedTargetPhrases = new StringVector<unsigned char, unsigned long, MmapAllocator>(true);
   }
+  m_passStart = util::WallTime();
   CompressTargetPhrases();
 
   std::cerr << "Saving to " << m_outPath << std::endl;
@@ -377,35 +381,73 @@ void PhraseTableCreator::CompressTargetPhrases()
   FlushCompressedQueue(true);
 }
 
-void PhraseTableCreator::CalcHuffmanCodes()
+void PhraseTableCreator::CalcSymbolTree()
 {
-  std::cerr << "\tCreating Huffman codes for " << m_symbolCounter.Size()
-            << " target phrase symbols" << std::endl;
-
   m_symbolTree = new SymbolTree(m_symbolCounter.Begin(),
                                 m_symbolCounter.End());
+}
 
-  std::vector<ScoreTree*>::iterator treeIt = m_scoreTrees.begin();
-  for(std::vector<ScoreCounter*>::iterator it = m_scoreCounters.begin();
-      it != m_scoreCounters.end(); it++) {
-    if(m_quantize)
-      (*it)->Quantize(m_quantize);
+void PhraseTableCreator::CalcScoreTree(size_t i)
+{
+  if(m_quantize)
+    m_scoreCounters[i]->Quantize(m_quantize);
 
-    std::cerr << "\tCreating Huffman codes for " << (*it)->Size()
-              << " scores" << std::endl;
+  m_scoreTrees[i] = new ScoreTree(m_scoreCounters[i]->Begin(),
+                                  m_scoreCounters[i]->End());
+}
 
-    *treeIt = new ScoreTree((*it)->Begin(), (*it)->End());
-    treeIt++;
-  }
+void PhraseTableCreator::CalcAlignTree()
+{
+  m_alignTree = new AlignTree(m_alignCounter.Begin(), m_alignCounter.End());
+}
+
+void PhraseTableCreator::CalcHuffmanCodes()
+{
+  // code sets are independent of each other
+#ifdef WITH_THREADS
+  boost::thread_group threads;
+  threads.create_thread(boost::bind(&PhraseTableCreator::CalcSymbolTree, this));
+  for(size_t i = 0; i < m_scoreCounters.size(); i++)
+    threads.create_thread(boost::bind(&PhraseTableCreator::CalcScoreTree, this, i));
+  if(m_useAlignmentInfo)
+    threads.create_thread(boost::bind(&PhraseTableCreator::CalcAlignTree, this));
+  threads.join_all();
+#else
+  CalcSymbolTree();
+  for(size_t i = 0; i < m_scoreCounters.size(); i++)
+    CalcScoreTree(i);
+  if(m_useAlignmentInfo)
+    CalcAlignTree();
+#endif
 
-  if(m_useAlignmentInfo) {
-    std::cerr << "\tCreating Huffman codes for " << m_alignCounter.Size()
+  std::cerr << "\tCreated Huffman codes for " << m_symbolCounter.Size()
+            << " target phrase symbols" << std::endl;
+  for(size_t i = 0; i < m_scoreCounters.size(); i++)
+    std::cerr << "\tCreated Huffman codes for " << m_scoreCounters[i]->Size()
+              << " scores" << std::endl;
+  if(m_useAlignmentInfo)
+    std::cerr << "\tCreated Huffman codes for " << m_alignCounter.Size()
               << " alignment points" << std::endl;
-    m_alignTree = new AlignTree(m_alignCounter.Begin(), m_alignCounter.End());
-  }
   std::cerr << std::endl;
 }
 
+void PhraseTableCreator::PrintProgress(size_t num)
+{
+  if(num % 100000 == 0)
+    std::cerr << ".";
+  if(num % 5000000 == 0) {
+    double seconds = util::WallTime() - m_passStart;
+    std::cerr << "[" << num << ", " << size_t(seconds) << "s, "
+              << size_t(seconds ? num / seconds : 0) << "/s]" << std::endl;
+  }
+}
+
+void PhraseTableCreator::PrintPassDone(size_t num, const std::string& what)
+{
+  std::cerr << std::endl << "\t" << num << " " << what << " in "
+            << size_t(util::WallTime() - m_passStart) << "s" << std::endl;
+}
+
 
 void PhraseTableCreator::AddSourceSymbolId(std::string& symbol)
 {
@@ -855,12 +897,7 @@ void PhraseTableCreator::FlushRankedQueue(bool force)
     if(m_lastFlushedSourcePhrase != pi.GetSrc()) {
       if(m_rankQueue.size()) {
         m_lastFlushedSourceNum++;
-        if(m_lastFlushedSourceNum % 100000 == 0) {
-          std::cerr << ".";
-        }
-        if(m_lastFlushedSourceNum % 5000000 == 0) {
-          std::cerr << "[" << m_lastFlushedSourceNum << "]" << std::endl;
-        }
+        PrintProgress(m_lastFlushedSourceNum);
 
         m_ranks.resize(m_lastFlushedLine + 1);
         int r = 0;
@@ -894,10 +931,11 @@ void PhraseTableCreator::FlushRankedQueue(bool force)
       m_rankQueue.pop();
     }
 
+    PrintPassDone(m_lastFlushedLine + 1, "phrase pairs ranked");
+    std::cerr << std::endl;
+
     m_lastFlushedLine = -1;
     m_lastFlushedSourceNum = 0;
-
-    std::cerr << std::endl << std::endl;
   }
 }
 
@@ -925,10 +963,7 @@ void PhraseTableCreator::FlushEncodedQueue(bool force)
         m_encodedTargetPhrases->push_back(targetPhraseCollection.str());
 
         m_lastFlushedSourceNum++;
-        if(m_lastFlushedSourceNum % 100000 == 0)
-          std::cerr << ".";
-        if(m_lastFlushedSourceNum % 5000000 == 0)
-          std::cerr << "[" << m_lastFlushedSourceNum << "]" << std::endl;
+        PrintProgress(m_lastFlushedSourceNum);
 
         m_lastCollection.clear();
       }
@@ -978,10 +1013,11 @@ void PhraseTableCreator::FlushEncodedQueue(bool force)
     m_srcHash.DropLastRange();
     m_srcHash.FinalizeSave();
 
+    PrintPassDone(m_encodedTargetPhrases->size(), "source phrases encoded");
+    std::cerr << std::endl;
+
     m_lastFlushedLine = -1;
     m_lastFlushedSourceNum = 0;
-
-    std::cerr << std::endl << std::endl;
   }
 }
 
@@ -1000,16 +1036,15 @@ void PhraseTableCreator::FlushCompressedQueue(bool force)
 
       m_compressedTargetPhrases->push_back(pi.GetTrg());
 
-      if((pi.GetLine()+1) % 100000 == 0)
-        std::cerr << ".";
-      if((pi.GetLine()+1) % 5000000 == 0)
-        std::cerr << "[" << (pi.GetLine()+1) << "]" << std::endl;
+      PrintProgress(pi.GetLine()+1);
     }
   }
 
   if(force) {
+    PrintPassDone(m_compressedTargetPhrases->size(), "target phrase collections compressed");
+    std::cerr << std::endl;
+
     m_lastFlushedLine = -1;
-    std::cerr << std::endl << std::endl;
   }
 }
 
@@ -53,9 +53,21 @@ public:
   typedef typename FreqMap::value_type value_type;
 
 private:
+  // Counts are collected in stripes with their own locks, so that encoding
+  // threads don't contend on a single mutex, and merged on first read.
+  static const size_t NUM_STRIPES = 16;
+
+  struct Stripe {
+#ifdef WITH_THREADS
+    boost::mutex m_mutex;
+#endif
+    FreqMap m_freqMap;
+  };
+
 #ifdef WITH_THREADS
   boost::mutex m_mutex;
 #endif
+  Stripe m_stripes[NUM_STRIPES];
   FreqMap m_freqMap;
   size_t m_maxSize;
   std::vector<DataType> m_bestVec;
@@ -71,32 +83,60 @@ private:
     }
   };
 
+  Stripe& GetStripe(const DataType& data) {
+    return m_stripes[boost::hash<DataType>()(data) % NUM_STRIPES];
+  }
+
+  // m_mutex must be held
+  void Merge() {
+    for(size_t i = 0; i < NUM_STRIPES; i++) {
+      Stripe& stripe = m_stripes[i];
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(stripe.m_mutex);
+#endif
+      for(iterator it = stripe.m_freqMap.begin();
+          it != stripe.m_freqMap.end(); it++)
+        m_freqMap[it->first] += it->second;
+      stripe.m_freqMap.clear();
+    }
+  }
+
 public:
   Counter() : m_maxSize(0) {}
 
   iterator Begin() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    Merge();
     return m_freqMap.begin();
   }
 
   iterator End() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    Merge();
     return m_freqMap.end();
   }
 
   void Increase(DataType data) {
-#ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
-#endif
-    m_freqMap[data]++;
+    IncreaseBy(data, 1);
   }
 
   void IncreaseBy(DataType data, size_t num) {
+    Stripe& stripe = GetStripe(data);
 #ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
+    boost::mutex::scoped_lock lock(stripe.m_mutex);
 #endif
-    m_freqMap[data] += num;
+    stripe.m_freqMap[data] += num;
   }
 
   mapped_type& operator[](DataType data) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    Merge();
     return m_freqMap[data];
   }
 
@@ -104,6 +144,7 @@ public:
 #ifdef WITH_THREADS
     boost::mutex::scoped_lock lock(m_mutex);
 #endif
+    Merge();
     return m_freqMap.size();
   }
 
@@ -111,6 +152,7 @@ public:
 #ifdef WITH_THREADS
     boost::mutex::scoped_lock lock(m_mutex);
 #endif
+    Merge();
     m_maxSize = maxSize;
     std::vector<std::pair<DataType, mapped_type> > freqVec;
     freqVec.insert(freqVec.begin(), m_freqMap.begin(), m_freqMap.end());
@@ -135,6 +177,7 @@ public:
 #ifdef WITH_THREADS
     boost::mutex::scoped_lock lock(m_mutex);
 #endif
+    Merge();
     m_freqMap.clear();
   }
 
@@ -212,6 +255,8 @@ private:
 
   size_t m_maxPhraseLength;
 
+  double m_passStart;
+
   std::vector<unsigned> m_ranks;
 
   typedef std::pair<unsigned, unsigned> SrcTrg;
@@ -315,8 +360,14 @@ private:
   void CreateRankHash();
   void EncodeTargetPhrases();
   void CalcHuffmanCodes();
+  void CalcSymbolTree();
+  void CalcScoreTree(size_t i);
+  void CalcAlignTree();
   void CompressTargetPhrases();
 
+  void PrintProgress(size_t num);
+  void PrintPassDone(size_t num, const std::string& what);
+
   void AddRankedLine(PackedItem& pi);
   void FlushRankedQueue(bool force = false);
 
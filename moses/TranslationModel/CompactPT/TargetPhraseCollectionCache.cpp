@@ -24,9 +24,152 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 namespace Moses
 {
 
+TargetPhraseCollectionCache::TargetPhraseCollectionCache(size_t max, bool shared)
+  : m_max(max), m_shared(shared)
+{
+  m_maxShardSize = m_shared ? (m_max + NUM_SHARDS - 1) / NUM_SHARDS : m_max;
+}
+
+TargetPhraseCollectionCache::Shard &
+TargetPhraseCollectionCache::GetShard(const Phrase &sourcePhrase)
+{
+  if(m_shared) {
+    size_t key = hash_value(sourcePhrase);
+    return m_shards[(key ^ (key >> 16)) % NUM_SHARDS];
+  }
+
+  if(!m_threadShard.get())
+    m_threadShard.reset(new Shard());
+  return *m_threadShard;
+}
+
+void
+TargetPhraseCollectionCache::
+Cache(const Phrase &sourcePhrase, TargetPhraseVectorPtr tpv,
+      size_t bitsLeft, size_t maxRank)
+{
+  if(m_maxShardSize == 0)
+    return;
+
+  if(maxRank && tpv->size() > maxRank)
+    tpv.reset(new TargetPhraseVector(tpv->begin(), tpv->begin() + maxRank));
+
+  Shard &shard = GetShard(sourcePhrase);
+  TargetPhraseVectorPtr evicted; // deleted after unlocking
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(shard.m_mutex, boost::defer_lock);
+  if(m_shared)
+    lock.lock();
+#endif
+
+  boost::unordered_map<Phrase, size_t>::iterator it
+  = shard.m_index.find(sourcePhrase);
+  if(it != shard.m_index.end()) {
+    // already cached, just mark as used
+    shard.m_slots[it->second].m_referenced = true;
+    return;
+  }
 
-boost::thread_specific_ptr<TargetPhraseCollectionCache::CacheMap>
-TargetPhraseCollectionCache::m_phraseCache;
+  if(shard.m_slots.size() < m_maxShardSize) {
+    shard.m_index[sourcePhrase] = shard.m_slots.size();
+    Slot slot = { sourcePhrase, tpv, bitsLeft, false };
+    shard.m_slots.push_back(slot);
+    return;
+  }
 
+  // clock. Referenced entries get a 2nd chance
+  while(shard.m_slots[shard.m_hand].m_referenced) {
+    shard.m_slots[shard.m_hand].m_referenced = false;
+    shard.m_hand = (shard.m_hand + 1) % shard.m_slots.size();
+  }
+
+  Slot &slot = shard.m_slots[shard.m_hand];
+  shard.m_index.erase(slot.m_phrase);
+  evicted = slot.m_tpv;
+  ++shard.m_evictions;
+
+  slot.m_phrase = sourcePhrase;
+  slot.m_tpv = tpv;
+  slot.m_bitsLeft = bitsLeft;
+  slot.m_referenced = false;
+  shard.m_index[sourcePhrase] = shard.m_hand;
+  shard.m_hand = (shard.m_hand + 1) % shard.m_slots.size();
 }
 
+std::pair<TargetPhraseVectorPtr, size_t>
+TargetPhraseCollectionCache::
+Retrieve(const Phrase &sourcePhrase)
+{
+  Shard &shard = GetShard(sourcePhrase);
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(shard.m_mutex, boost::defer_lock);
+  if(m_shared)
+    lock.lock();
+#endif
+
+  boost::unordered_map<Phrase, size_t>::const_iterator it
+  = shard.m_index.find(sourcePhrase);
+  if(it == shard.m_index.end()) {
+    ++shard.m_misses;
+    return std::make_pair(TargetPhraseVectorPtr(), 0);
+  }
+
+  ++shard.m_hits;
+  Slot &slot = shard.m_slots[it->second];
+  slot.m_referenced = true;
+  return std::make_pair(slot.m_tpv, slot.m_bitsLeft);
+}
+
+void
+TargetPhraseCollectionCache::
+CleanUp()
+{
+  std::vector<Shard*> shards;
+  if(m_shared) {
+    for(size_t i = 0; i < NUM_SHARDS; ++i)
+      shards.push_back(&m_shards[i]);
+  } else if(m_threadShard.get())
+    shards.push_back(m_threadShard.get());
+
+  for(size_t i = 0; i < shards.size(); ++i) {
+    Shard &shard = *shards[i];
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(shard.m_mutex);
+#endif
+    shard.m_index.clear();
+    shard.m_slots.clear();
+    shard.m_hand = 0;
+  }
+}
+
+void
+TargetPhraseCollectionCache::
+Debug(std::ostream &out)
+{
+  size_t size = 0, hits = 0, misses = 0, evictions = 0;
+  if(m_shared) {
+    for(size_t i = 0; i < NUM_SHARDS; ++i) {
+      Shard &shard = m_shards[i];
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(shard.m_mutex);
+#endif
+      size += shard.m_slots.size();
+      hits += shard.m_hits;
+      misses += shard.m_misses;
+      evictions += shard.m_evictions;
+    }
+  } else if(m_threadShard.get()) {
+    const Shard &shard = *m_threadShard;
+    size = shard.m_slots.size();
+    hits = shard.m_hits;
+    misses = shard.m_misses;
+    evictions = shard.m_evictions;
+  }
+
+  out << "size=" << size << "/" << m_max
+      << " hits=" << hits
+      << " misses=" << misses
+      << " evictions=" << evictions;
+}
+
+}
@@ -22,12 +22,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef moses_TargetPhraseCollectionCache_h
 #define moses_TargetPhraseCollectionCache_h
 
-#include <map>
-#include <set>
+#include <iostream>
 #include <vector>
 
 #include <boost/thread/tss.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
 
 #include "moses/Phrase.h"
 #include "moses/TargetPhraseCollection.h"
@@ -39,123 +43,60 @@ namespace Moses
 typedef std::vector<TargetPhrase> TargetPhraseVector;
 typedef boost::shared_ptr<TargetPhraseVector> TargetPhraseVectorPtr;
 
-/** Implementation of Persistent Cache **/
+/** Implementation of Persistent Cache.
+  * Decoded target phrase collections hashed by source phrase. Each thread has
+  * its own cache unless shared, in which case all threads use one cache split
+  * into locked shards. Size is bounded by CLOCK eviction on insert, so there's
+  * no periodic pruning. Cached collections are never changed.
+  **/
 class TargetPhraseCollectionCache
 {
 private:
-  size_t m_max;
-  float m_tolerance;
-
-  struct LastUsed {
-    clock_t m_clock;
+  struct Slot {
+    Phrase m_phrase;
     TargetPhraseVectorPtr m_tpv;
     size_t m_bitsLeft;
+    bool m_referenced;
+  };
+
+  struct Shard {
+#ifdef WITH_THREADS
+    boost::mutex m_mutex;
+#endif
+    boost::unordered_map<Phrase, size_t> m_index; // phrase -> slot
+    std::vector<Slot> m_slots;
+    size_t m_hand;
 
-    LastUsed() : m_clock(0), m_bitsLeft(0) {}
+    size_t m_hits, m_misses, m_evictions;
 
-    LastUsed(clock_t clock, TargetPhraseVectorPtr tpv, size_t bitsLeft = 0)
-      : m_clock(clock), m_tpv(tpv), m_bitsLeft(bitsLeft) {}
+    Shard() : m_hand(0), m_hits(0), m_misses(0), m_evictions(0) {}
   };
 
-  typedef std::map<Phrase, LastUsed> CacheMap;
-  static boost::thread_specific_ptr<CacheMap> m_phraseCache;
+  static const size_t NUM_SHARDS = 16;
+
+  size_t m_max;
+  bool m_shared;
+  size_t m_maxShardSize;
+
+  Shard m_shards[NUM_SHARDS];
+  boost::thread_specific_ptr<Shard> m_threadShard;
+
+  Shard &GetShard(const Phrase &sourcePhrase);
 
 public:
+  TargetPhraseCollectionCache(size_t max = 5000, bool shared = false);
 
-  typedef CacheMap::iterator iterator;
-  typedef CacheMap::const_iterator const_iterator;
-
-  TargetPhraseCollectionCache(size_t max = 5000, float tolerance = 0.2)
-    : m_max(max), m_tolerance(tolerance) {
-  }
-
-  iterator Begin() {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    return m_phraseCache->begin();
-  }
-
-  const_iterator Begin() const {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    return m_phraseCache->begin();
-  }
-
-  iterator End() {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    return m_phraseCache->end();
-  }
-
-  const_iterator End() const {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    return m_phraseCache->end();
-  }
-
-  /** retrieve translations for source phrase from persistent cache **/
+  /** add translations for source phrase to cache, keeping at most maxRank **/
   void Cache(const Phrase &sourcePhrase, TargetPhraseVectorPtr tpv,
-             size_t bitsLeft = 0, size_t maxRank = 0) {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    // check if source phrase is already in cache
-    iterator it = m_phraseCache->find(sourcePhrase);
-    if(it != m_phraseCache->end())
-      // if found, just update clock
-      it->second.m_clock = clock();
-    else {
-      // else, add to cache
-      if(maxRank && tpv->size() > maxRank) {
-        TargetPhraseVectorPtr tpv_temp(new TargetPhraseVector());
-        tpv_temp->resize(maxRank);
-        std::copy(tpv->begin(), tpv->begin() + maxRank, tpv_temp->begin());
-        (*m_phraseCache)[sourcePhrase] = LastUsed(clock(), tpv_temp, bitsLeft);
-      } else
-        (*m_phraseCache)[sourcePhrase] = LastUsed(clock(), tpv, bitsLeft);
-    }
-  }
-
-  std::pair<TargetPhraseVectorPtr, size_t> Retrieve(const Phrase &sourcePhrase) {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    iterator it = m_phraseCache->find(sourcePhrase);
-    if(it != m_phraseCache->end()) {
-      LastUsed &lu = it->second;
-      lu.m_clock = clock();
-      return std::make_pair(lu.m_tpv, lu.m_bitsLeft);
-    } else
-      return std::make_pair(TargetPhraseVectorPtr(), 0);
-  }
-
-  // if cache full, reduce
-  void Prune() {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    if(m_phraseCache->size() > m_max * (1 + m_tolerance)) {
-      typedef std::set<std::pair<clock_t, Phrase> > Cands;
-      Cands cands;
-      for(CacheMap::iterator it = m_phraseCache->begin();
-          it != m_phraseCache->end(); it++) {
-        LastUsed &lu = it->second;
-        cands.insert(std::make_pair(lu.m_clock, it->first));
-      }
-
-      for(Cands::iterator it = cands.begin(); it != cands.end(); it++) {
-        const Phrase& p = it->second;
-        m_phraseCache->erase(p);
-
-        if(m_phraseCache->size() < (m_max * (1 - m_tolerance)))
-          break;
-      }
-    }
-  }
-
-  void CleanUp() {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    m_phraseCache->clear();
-  }
+             size_t bitsLeft = 0, size_t maxRank = 0);
+
+  /** retrieve translations for source phrase from cache **/
+  std::pair<TargetPhraseVectorPtr, size_t> Retrieve(const Phrase &sourcePhrase);
+
+  void CleanUp();
 
+  // stats of this thread's cache, or of the shared one
+  void Debug(std::ostream &out);
 };
 
 }
@@ -38,9 +38,7 @@ void ExamplePT::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQue
 
     // add target phrase to phrase-table cache
     size_t hash = hash_value(sourcePhrase);
-    std::pair<TargetPhraseCollection::shared_ptr, clock_t>
-    value(tpColl, clock());
-    cache[hash] = value;
+    cache.Insert(hash, tpColl);
 
     inputPath.SetTargetPhrases(*this, tpColl, NULL);
   }
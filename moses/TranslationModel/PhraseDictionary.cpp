@@ -20,6 +20,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ***********************************************************************/
 
 #include <queue>
+#include <sstream>
 #include "moses/TranslationModel/PhraseDictionary.h"
 #include "moses/StaticData.h"
 #include "moses/InputType.h"
@@ -39,6 +40,7 @@ PhraseDictionary::PhraseDictionary(const std::string &line, bool registerNow)
   : DecodeFeature(line, registerNow)
   , m_tableLimit(20) // default
   , m_maxCacheSize(DEFAULT_MAX_TRANS_OPT_CACHE_SIZE)
+  , m_cache(DEFAULT_MAX_TRANS_OPT_CACHE_SIZE)
 {
   m_id = s_staticColl.size();
   s_staticColl.push_back(this);
@@ -56,25 +58,18 @@ PhraseDictionary::
 GetTargetPhraseCollectionLEGACY(const Phrase& src) const
 {
   TargetPhraseCollection::shared_ptr ret;
-  typedef std::pair<TargetPhraseCollection::shared_ptr , clock_t> entry;
   if (m_maxCacheSize) {
     CacheColl &cache = GetCache();
 
     size_t hash = hash_value(src);
 
-    CacheColl::iterator iter;
-    iter = cache.find(hash);
-
-    if (iter == cache.end()) {
+    if (!cache.Find(hash, ret)) {
       // not in cache, need to look up from phrase table
       ret = GetTargetPhraseCollectionNonCacheLEGACY(src);
       if (ret) { // make a copy
         ret.reset(new TargetPhraseCollection(*ret));
       }
-      cache[hash] = entry(ret, clock());
-    } else { // in cache. just use it
-      iter->second.second = clock();
-      ret = iter->second.first;
+      cache.Insert(hash, ret);
     }
   } else {
     // don't use cache. look up from phrase table
@@ -105,6 +100,7 @@ SetParameter(const std::string& key, const std::string& value)
 {
   if (key == "cache-size") {
     m_maxCacheSize = Scan<size_t>(value);
+    m_cache.SetMaxSize(m_maxCacheSize);
   } else if (key == "path") {
     m_filePath = value;
   } else if (key == "table-limit") {
@@ -164,51 +160,21 @@ GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
   }
 }
 
-// reduce presistent cache by half of maximum size
+// the cache is shared and keeps itself within m_maxCacheSize. Just report on it
 void PhraseDictionary::ReduceCache() const
 {
-  Timer reduceCacheTime;
-  reduceCacheTime.start();
-  CacheColl &cache = GetCache();
-  if (cache.size() <= m_maxCacheSize) return; // not full
-
-  // find cutoff for last used time
-  priority_queue< clock_t > lastUsedTimes;
-  CacheColl::iterator iter;
-  iter = cache.begin();
-  while( iter != cache.end() ) {
-    lastUsedTimes.push( iter->second.second );
-    iter++;
-  }
-  for( size_t i=0; i < lastUsedTimes.size()-m_maxCacheSize/2; i++ )
-    lastUsedTimes.pop();
-  clock_t cutoffLastUsedTime = lastUsedTimes.top();
-
-  // remove all old entries
-  iter = cache.begin();
-  while( iter != cache.end() ) {
-    if (iter->second.second < cutoffLastUsedTime) {
-      CacheColl::iterator iterRemove = iter++;
-      // delete iterRemove->second.first;
-      cache.erase(iterRemove);
-    } else iter++;
+  IFVERBOSE(2) {
+    std::stringstream strme;
+    m_cache.Debug(strme);
+    VERBOSE(2, GetScoreProducerDescription() << " cache: " << strme.str() << std::endl);
   }
-  VERBOSE(2,"Reduced persistent translation option cache in "
-          << reduceCacheTime << " seconds." << std::endl);
 }
 
 CacheColl &
 PhraseDictionary::
 GetCache() const
 {
-  CacheColl *cache;
-  cache = m_cache.get();
-  if (cache == NULL) {
-    cache = new CacheColl;
-    m_cache.reset(cache);
-  }
-  assert(cache);
-  return *cache;
+  return m_cache;
 }
 
 bool PhraseDictionary::SatisfyBackoff(const InputPath &inputPath) const
@@ -32,19 +32,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <string>
 #include <boost/unordered_map.hpp>
 
-#ifdef WITH_THREADS
-#include <boost/thread/tss.hpp>
-#else
-#include <boost/scoped_ptr.hpp>
-#include <ctime>
-#endif
-
 #include "moses/Phrase.h"
 #include "moses/TargetPhrase.h"
 #include "moses/TargetPhraseCollection.h"
 #include "moses/InputPath.h"
 #include "moses/FF/DecodeFeature.h"
 #include "moses/ContextScope.h"
+#include "moses/TranslationModel/CacheColl.h"
 
 namespace Moses
 {
@@ -56,10 +50,6 @@ class ChartCellCollectionBase;
 class ChartRuleLookupManager;
 class ChartParser;
 
-// typedef std::pair<TargetPhraseCollection::shared_ptr, clock_t> TPCollLastUse;
-typedef std::pair<TargetPhraseCollection::shared_ptr, clock_t> CacheCollEntry;
-typedef boost::unordered_map<size_t, CacheCollEntry> CacheColl;
-
 /**
   * Abstract base class for phrase dictionaries (tables).
   **/
@@ -168,15 +158,9 @@ protected:
 
   bool SatisfyBackoff(const InputPath &inputPath) const;
 
-  // cache
+  // cache, shared by all threads
   size_t m_maxCacheSize; // 0 = no caching
-
-#ifdef WITH_THREADS
-  //reader-writer lock
-  mutable boost::thread_specific_ptr<CacheColl> m_cache;
-#else
-  mutable boost::scoped_ptr<CacheColl> m_cache;
-#endif
+  mutable CacheColl m_cache;
 
   virtual
   TargetPhraseCollection::shared_ptr
@@ -42,6 +42,11 @@
 #include "util/double-conversion/double-conversion.h"
 #include "util/exception.hh"
 
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#endif
+
 using namespace std;
 using namespace boost::algorithm;
 
@@ -140,86 +145,68 @@ void ReformatHieroRule(const string &lineOrig, string &out)
   out = ret.str();
 }
 
-bool RuleTableLoaderStandard::Load(AllOptions const& opts, FormatType format
-                                   , const std::vector<FactorType> &input
-                                   , const std::vector<FactorType> &output
-                                   , const std::string &inFile
-                                   , size_t /* tableLimit */
-                                   , RuleTableTrie &ruleTable)
+void RuleTableLoaderStandard::ParseLine(AllOptions const& opts, FormatType format
+    , const std::vector<FactorType> &input
+    , const std::vector<FactorType> &output
+    , StringPiece line
+    , size_t count
+    , RuleTableTrie &ruleTable
+    , ParsedRule &rule) const
 {
-  PrintUserTime(string("Start loading text phrase table. ") + (format==MosesFormat?"Moses":"Hiero") + " format");
-
-  // const StaticData &staticData = StaticData::Instance();
+  rule.sourcePhrase.Clear();
+  rule.targetPhrase = NULL;
+  rule.sourceLHS = NULL;
 
-  string lineOrig;
-  size_t count = 0;
-
-  std::ostream *progress = NULL;
-  IFVERBOSE(1) progress = &std::cerr;
-  util::FilePiece in(inFile.c_str(), progress);
-
-  // reused variables
-  vector<float> scoreVector;
-  StringPiece line;
   std::string hiero_before, hiero_after;
+  if (format == HieroFormat) { // inefficiently reformat line
+    hiero_before.assign(line.data(), line.size());
+    ReformatHieroRule(hiero_before, hiero_after);
+    line = hiero_after;
+  }
 
-  double_conversion::StringToDoubleConverter converter(double_conversion::StringToDoubleConverter::NO_FLAGS, NAN, NAN, "inf", "nan");
-
-  while(true) {
-    try {
-      line = in.ReadLine();
-    } catch (const util::EndOfFileException &e) {
-      break;
-    }
+  util::TokenIter<util::MultiCharacter> pipes(line, "|||");
+  StringPiece sourcePhraseString(*pipes);
+  StringPiece targetPhraseString(*++pipes);
+  StringPiece scoreString(*++pipes);
 
-    if (format == HieroFormat) { // inefficiently reformat line
-      hiero_before.assign(line.data(), line.size());
-      ReformatHieroRule(hiero_before, hiero_after);
-      line = hiero_after;
-    }
-
-    util::TokenIter<util::MultiCharacter> pipes(line, "|||");
-    StringPiece sourcePhraseString(*pipes);
-    StringPiece targetPhraseString(*++pipes);
-    StringPiece scoreString(*++pipes);
+  StringPiece alignString;
+  if (++pipes) {
+    StringPiece temp(*pipes);
+    alignString = temp;
+  }
 
-    StringPiece alignString;
-    if (++pipes) {
-      StringPiece temp(*pipes);
-      alignString = temp;
-    }
+  bool isLHSEmpty = (sourcePhraseString.find_first_not_of(" \t", 0) == string::npos);
+  if (isLHSEmpty && !opts.unk.word_deletion_enabled) {
+    TRACE_ERR( ruleTable.GetFilePath() << ":" << count << ": pt entry contains empty target, skipping\n");
+    return;
+  }
 
-    bool isLHSEmpty = (sourcePhraseString.find_first_not_of(" \t", 0) == string::npos);
-    if (isLHSEmpty && !opts.unk.word_deletion_enabled) {
-      TRACE_ERR( ruleTable.GetFilePath() << ":" << count << ": pt entry contains empty target, skipping\n");
-      continue;
-    }
+  double_conversion::StringToDoubleConverter converter(double_conversion::StringToDoubleConverter::NO_FLAGS, NAN, NAN, "inf", "nan");
 
-    scoreVector.clear();
-    for (util::TokenIter<util::AnyCharacter, true> s(scoreString, " \t"); s; ++s) {
-      int processed;
-      float score = converter.StringToFloat(s->data(), s->length(), &processed);
-      UTIL_THROW_IF2(isnan(score), "Bad score " << *s << " on line " << count);
-      scoreVector.push_back(FloorScore(TransformScore(score)));
-    }
-    const size_t numScoreComponents = ruleTable.GetNumScoreComponents();
-    if (scoreVector.size() != numScoreComponents) {
-      UTIL_THROW2("Size of scoreVector != number (" << scoreVector.size() << "!="
-                  << numScoreComponents << ") of score components on line " << count);
-    }
+  vector<float> scoreVector;
+  for (util::TokenIter<util::AnyCharacter, true> s(scoreString, " \t"); s; ++s) {
+    int processed;
+    float score = converter.StringToFloat(s->data(), s->length(), &processed);
+    UTIL_THROW_IF2(isnan(score), "Bad score " << *s << " on line " << count);
+    scoreVector.push_back(FloorScore(TransformScore(score)));
+  }
+  const size_t numScoreComponents = ruleTable.GetNumScoreComponents();
+  if (scoreVector.size() != numScoreComponents) {
+    UTIL_THROW2("Size of scoreVector != number (" << scoreVector.size() << "!="
+                << numScoreComponents << ") of score components on line " << count);
+  }
 
-    // parse source & find pt node
+  // parse source & find pt node
 
-    // constituent labels
-    Word *sourceLHS = NULL;
-    Word *targetLHS;
+  // constituent labels
+  Word *targetLHS;
 
-    // create target phrase obj
-    TargetPhrase *targetPhrase = new TargetPhrase(&ruleTable);
+  // create target phrase obj
+  TargetPhrase *targetPhrase = new TargetPhrase(&ruleTable);
+  try {
     targetPhrase->CreateFromString(Output, output, targetPhraseString, &targetLHS);
     // source
-    Phrase sourcePhrase;
-    sourcePhrase.CreateFromString(Input, input, sourcePhraseString, &sourceLHS);
+    rule.sourcePhrase.CreateFromString(Input, input, sourcePhraseString, &rule.sourceLHS);
 
     // rest of target phrase
     targetPhrase->SetAlignmentInfo(alignString);
@@ -238,17 +225,137 @@ bool RuleTableLoaderStandard::Load(AllOptions const& opts, FormatType format
     }
 
     targetPhrase->GetScoreBreakdown().Assign(&ruleTable, scoreVector);
-    targetPhrase->EvaluateInIsolation(sourcePhrase, ruleTable.GetFeaturesToApply());
+    targetPhrase->EvaluateInIsolation(rule.sourcePhrase, ruleTable.GetFeaturesToApply());
+  } catch (...) {
+    delete targetPhrase;
+    delete rule.sourceLHS;
+    rule.sourceLHS = NULL;
+    throw;
+  }
 
-    TargetPhraseCollection::shared_ptr phraseColl
-    = GetOrCreateTargetPhraseCollection(ruleTable, sourcePhrase,
-                                        *targetPhrase, sourceLHS);
-    phraseColl->Add(targetPhrase);
+  rule.targetPhrase = targetPhrase;
+}
 
-    // not implemented correctly in memory pt. just delete it for now
-    delete sourceLHS;
+void RuleTableLoaderStandard::ParseBatch::Parse(size_t begin, size_t end, std::string &error)
+{
+  // exceptions don't cross threads, rethrown by the caller
+  try {
+    for (size_t i = begin; i < end; ++i) {
+      loader->ParseLine(*opts, format, *input, *output, lines[i], count + i + 1, *ruleTable, rules[i]);
+    }
+  } catch (const std::exception &e) {
+    error = e.what();
+  }
+}
+
+void RuleTableLoaderStandard::AddRule(RuleTableTrie &ruleTable, ParsedRule &rule)
+{
+  TargetPhraseCollection::shared_ptr phraseColl
+  = GetOrCreateTargetPhraseCollection(ruleTable, rule.sourcePhrase,
+                                      *rule.targetPhrase, rule.sourceLHS);
+  phraseColl->Add(rule.targetPhrase);
+
+  // not implemented correctly in memory pt. just delete it for now
+  delete rule.sourceLHS;
+}
+
+bool RuleTableLoaderStandard::Load(AllOptions const& opts, FormatType format
+                                   , const std::vector<FactorType> &input
+                                   , const std::vector<FactorType> &output
+                                   , const std::string &inFile
+                                   , size_t /* tableLimit */
+                                   , RuleTableTrie &ruleTable)
+{
+  PrintUserTime(string("Start loading text phrase table. ") + (format==MosesFormat?"Moses":"Hiero") + " format");
 
-    count++;
+  size_t count = 0; // lines read, for error messages
+
+  std::ostream *progress = NULL;
+  IFVERBOSE(1) progress = &std::cerr;
+  util::FilePiece in(inFile.c_str(), progress);
+
+  size_t threads = ruleTable.GetLoadThreads();
+#ifndef WITH_THREADS
+  threads = 1;
+#endif
+
+  if (threads <= 1) {
+    StringPiece line;
+    ParsedRule rule;
+    while(true) {
+      try {
+        line = in.ReadLine();
+      } catch (const util::EndOfFileException &e) {
+        break;
+      }
+
+      ++count;
+      ParseLine(opts, format, input, output, line, count, ruleTable, rule);
+      if (rule.targetPhrase) {
+        AddRule(ruleTable, rule);
+      }
+    }
+  } else {
+#ifdef WITH_THREADS
+    // Lines are read and parsed in batches, one slice per thread. Rules are
+    // added to the trie in file order on this thread, which is cheap
+    // compared to parsing.
+    const size_t batchSize = 10000 * threads;
+    ParseBatch batch;
+    batch.loader = this;
+    batch.opts = &opts;
+    batch.format = format;
+    batch.input = &input;
+    batch.output = &output;
+    batch.ruleTable = &ruleTable;
+    batch.lines.reserve(batchSize);
+
+    bool eof = false;
+    while (!eof) {
+      batch.lines.clear();
+      try {
+        while (batch.lines.size() < batchSize) {
+          StringPiece line = in.ReadLine();
+          batch.lines.push_back(std::string(line.data(), line.size()));
+        }
+      } catch (const util::EndOfFileException &e) {
+        eof = true;
+      }
+
+      batch.count = count;
+      batch.rules.clear();
+      batch.rules.resize(batch.lines.size());
+
+      boost::thread_group workers;
+      std::vector<std::string> errors(threads);
+      size_t sliceSize = (batch.lines.size() + threads - 1) / threads;
+      for (size_t t = 0; t < threads; ++t) {
+        size_t begin = std::min(t * sliceSize, batch.lines.size());
+        size_t end = std::min(begin + sliceSize, batch.lines.size());
+        workers.create_thread(boost::bind(&ParseBatch::Parse, &batch, begin, end,
+                                          boost::ref(errors[t])));
+      }
+      workers.join_all();
+
+      for (size_t t = 0; t < threads; ++t) {
+        if (!errors[t].empty()) {
+          // the rules parsed so far never reach the table
+          for (size_t i = 0; i < batch.rules.size(); ++i) {
+            delete batch.rules[i].targetPhrase;
+            delete batch.rules[i].sourceLHS;
+          }
+          UTIL_THROW2(errors[t]);
+        }
+      }
+
+      for (size_t i = 0; i < batch.rules.size(); ++i) {
+        if (batch.rules[i].targetPhrase) {
+          AddRule(ruleTable, batch.rules[i]);
+        }
+      }
+      count += batch.lines.size();
+    }
+#endif
   }
 
   // sort and prune each target phrase collection
@@ -20,6 +20,10 @@
 #pragma once
 
 #include "Loader.h"
+#include <string>
+#include <vector>
+#include "moses/Phrase.h"
+#include "util/string_piece.hh"
 
 namespace Moses
 {
@@ -28,6 +32,41 @@ namespace Moses
 class RuleTableLoaderStandard : public RuleTableLoader
 {
 protected:
+  struct ParsedRule {
+    Phrase sourcePhrase;
+    TargetPhrase *targetPhrase; // NULL if the line was skipped
+    Word *sourceLHS;
+
+    ParsedRule() : targetPhrase(NULL), sourceLHS(NULL) {}
+  };
+
+  // everything except adding the rule to the table, so that lines can be
+  // parsed on several threads
+  void ParseLine(AllOptions const& opts,
+                 FormatType format,
+                 const std::vector<FactorType> &input,
+                 const std::vector<FactorType> &output,
+                 StringPiece line,
+                 size_t count,
+                 RuleTableTrie &ruleTable,
+                 ParsedRule &rule) const;
+
+  // one batch of lines, parsed in slices on several threads
+  struct ParseBatch {
+    const RuleTableLoaderStandard *loader;
+    const AllOptions *opts;
+    FormatType format;
+    const std::vector<FactorType> *input;
+    const std::vector<FactorType> *output;
+    RuleTableTrie *ruleTable;
+    size_t count;
+    std::vector<std::string> lines;
+    std::vector<ParsedRule> rules;
+
+    void Parse(size_t begin, size_t end, std::string &error);
+  };
+
+  void AddRule(RuleTableTrie &ruleTable, ParsedRule &rule);
 
   bool Load(AllOptions const& opts,
             FormatType format,
@@ -176,20 +176,10 @@ GetTargetPhraseCollection(const OnDiskPt::PhraseNode *ptNode) const
   CacheColl &cache = GetCache();
   size_t hash = (size_t) ptNode->GetFilePos();
 
-  CacheColl::iterator iter;
-
-  iter = cache.find(hash);
-
-  if (iter == cache.end()) {
+  if (!cache.Find(hash, ret)) {
     // not in cache, need to look up from phrase table
     ret = GetTargetPhraseCollectionNonCache(ptNode);
-
-    std::pair<TargetPhraseCollection::shared_ptr , clock_t> value(ret, clock());
-    cache[hash] = value;
-  } else {
-    // in cache. just use it
-    iter->second.second = clock();
-    ret = iter->second.first;
+    cache.Insert(hash, ret);
   }
 
   return ret;
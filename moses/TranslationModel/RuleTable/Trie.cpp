@@ -51,4 +51,22 @@ void RuleTableTrie::Load(AllOptions::ptr const& opts)
   }
 }
 
+void RuleTableTrie::SetParameter(const std::string& key, const std::string& value)
+{
+  if (key == "load-threads") {
+    m_loadThreads = Scan<size_t>(value);
+  } else {
+    PhraseDictionary::SetParameter(key, value);
+  }
+}
+
+size_t RuleTableTrie::GetLoadThreads() const
+{
+  if (m_loadThreads) {
+    return m_loadThreads;
+  }
+  int threads = StaticData::Instance().ThreadCount();
+  return threads > 0 ? threads : 1;
+}
+
 }  // namespace Moses
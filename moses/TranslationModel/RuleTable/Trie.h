@@ -41,13 +41,19 @@ class RuleTableTrie : public PhraseDictionary
 {
 public:
   RuleTableTrie(const std::string &line)
-    : PhraseDictionary(line, true) {
+    : PhraseDictionary(line, true)
+    , m_loadThreads(1) {
   }
 
   virtual ~RuleTableTrie();
 
   void Load(AllOptions::ptr const& opts);
 
+  void SetParameter(const std::string& key, const std::string& value);
+
+  //! number of threads parsing the text table. Default 1, 0 = same as decoding
+  size_t GetLoadThreads() const;
+
 private:
   friend class RuleTableLoader;
 
@@ -58,6 +64,7 @@ private:
 
   virtual void SortAndPrune() = 0;
 
+  size_t m_loadThreads;
 };
 
 }  // namespace Moses
@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TypeDef.h"
 #include "ScoreComponentCollection.h"
 #include "StaticData.h"
+#include "Arena.h"
 namespace Moses
 {
 
@@ -59,7 +60,7 @@ class LexicalReordering;
  * m_targetPhrase points to a phrase-table entry.
  * The source word range is zero-indexed, so it can't refer to an empty range. The target phrase may be empty.
  */
-class TranslationOption
+class TranslationOption : public ArenaAllocated
 {
   friend std::ostream& operator<<(std::ostream& out, const TranslationOption& possibleTranslation);
 
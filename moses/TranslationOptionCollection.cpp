@@ -42,6 +42,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "util/exception.hh"
 
 #include <boost/foreach.hpp>
+#include <boost/scoped_ptr.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread.hpp>
+#endif
 using namespace std;
 
 namespace Moses
@@ -338,37 +342,38 @@ CreateTranslationOptions()
   // table loaded on initialization), generate TranslationOption objects
   // for all phrases
 
-  // there may be multiple decoding graphs (factorizations of decoding)
-  const vector <DecodeGraph*> &decodeGraphList
-  = StaticData::Instance().GetDecodeGraphs();
-
   // length of the sentence
   const size_t size = m_source.GetSize();
 
-  // loop over all decoding graphs, each generates translation options
-  for (size_t gidx = 0 ; gidx < decodeGraphList.size() ; gidx++) {
-    if (decodeGraphList.size() > 1)
-      VERBOSE(3,"Creating translation options from decoding graph " << gidx << endl);
+  size_t threads = std::min(GetNumTranslationOptionThreads(), size);
+#ifndef WITH_THREADS
+  threads = 1;
+#endif
 
-    const DecodeGraph& dg = *decodeGraphList[gidx];
-    size_t backoff = dg.GetBackoff();
-    // iterate over spans
+  if (threads <= 1) {
     for (size_t sPos = 0 ; sPos < size; sPos++) {
-      size_t maxSize = size - sPos; // don't go over end of sentence
-      // size_t maxSizePhrase = StaticData::Instance().GetMaxPhraseLength();
-      maxSize = std::min(maxSize, m_max_phrase_length);
-
-      for (size_t ePos = sPos ; ePos < sPos + maxSize ; ePos++) {
-        if (gidx && backoff &&
-            (ePos-sPos+1 <= backoff || // size exceeds backoff limit (HUH? UG) or ...
-             m_collection[sPos][ePos-sPos].size() > 0)) {
-          VERBOSE(3,"No backoff to graph " << gidx << " for span [" << sPos << ";" << ePos << "]" << endl);
-          continue;
-        }
-        CreateTranslationOptionsForRange(dg, sPos, ePos, true, gidx);
-      }
+      CreateTranslationOptionsForStart(sPos);
     }
+  } else {
+#ifdef WITH_THREADS
+    // spans with different start positions go to different lists, so
+    // they can be done in parallel. This thread takes its share too
+    boost::thread_group workers;
+    std::vector<std::string> errors(threads);
+    for (size_t t = 1; t < threads; ++t) {
+      m_arenas.push_back(new Arena);
+      workers.create_thread(boost::bind(&TranslationOptionCollection::CreateTranslationOptionsForStarts,
+                                        this, t, threads, &m_arenas.back(), &errors[t]));
+    }
+    CreateTranslationOptionsForStarts(0, threads, NULL, &errors[0]);
+    workers.join_all();
+
+    for (size_t t = 0; t < threads; ++t) {
+      UTIL_THROW_IF2(!errors[t].empty(), errors[t]);
+    }
+#endif
   }
+
   ProcessUnknownWord();
   EvaluateWithSourceContext();
   VERBOSE(3,"Translation Option Collection\n " << *this << endl);
@@ -379,6 +384,52 @@ CreateTranslationOptions()
 }
 
 
+void
+TranslationOptionCollection::
+CreateTranslationOptionsForStart(size_t sPos)
+{
+  // there may be multiple decoding graphs (factorizations of decoding)
+  const vector <DecodeGraph*> &decodeGraphList
+  = StaticData::Instance().GetDecodeGraphs();
+
+  size_t maxSize = m_source.GetSize() - sPos; // don't go over end of sentence
+  maxSize = std::min(maxSize, m_max_phrase_length);
+
+  // loop over all decoding graphs, each generates translation options
+  for (size_t gidx = 0 ; gidx < decodeGraphList.size() ; gidx++) {
+    if (decodeGraphList.size() > 1)
+      VERBOSE(3,"Creating translation options from decoding graph " << gidx
+              << " at " << sPos << endl);
+
+    const DecodeGraph& dg = *decodeGraphList[gidx];
+    size_t backoff = dg.GetBackoff();
+    for (size_t ePos = sPos ; ePos < sPos + maxSize ; ePos++) {
+      if (gidx && backoff &&
+          (ePos-sPos+1 <= backoff || // size exceeds backoff limit (HUH? UG) or ...
+           m_collection[sPos][ePos-sPos].size() > 0)) {
+        VERBOSE(3,"No backoff to graph " << gidx << " for span [" << sPos << ";" << ePos << "]" << endl);
+        continue;
+      }
+      CreateTranslationOptionsForRange(dg, sPos, ePos, true, gidx);
+    }
+  }
+}
+
+void
+TranslationOptionCollection::
+CreateTranslationOptionsForStarts(size_t first, size_t step, Arena *arena, std::string *error)
+{
+  // exceptions don't cross threads, rethrown by the caller
+  try {
+    boost::scoped_ptr<Arena::Scope> arenaScope(arena ? new Arena::Scope(*arena) : NULL);
+    for (size_t sPos = first; sPos < m_source.GetSize(); sPos += step) {
+      CreateTranslationOptionsForStart(sPos);
+    }
+  } catch (const std::exception &e) {
+    *error = e.what();
+  }
+}
+
 bool
 TranslationOptionCollection::
 CreateTranslationOptionsForRange
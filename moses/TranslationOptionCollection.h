@@ -24,7 +24,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define moses_TranslationOptionCollection_h
 
 #include <list>
+#include <string>
 #include <boost/unordered_map.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include "TypeDef.h"
 #include "TranslationOption.h"
 #include "TranslationOptionList.h"
@@ -33,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "PartialTranslOptColl.h"
 #include "DecodeStep.h"
 #include "InputPath.h"
+#include "Arena.h"
 
 namespace Moses
 {
@@ -66,6 +69,7 @@ class TranslationOptionCollection
   TranslationOptionCollection(const TranslationOptionCollection&); /*< no copy constructor */
 protected:
   ttaskwptr m_ttask; // that is and must be a weak pointer!
+  boost::ptr_vector<Arena> m_arenas; /*< for options created by worker threads. Outlives m_collection */
   std::vector< std::vector< TranslationOptionList > >	m_collection; /*< contains translation options */
   InputType const &m_source; /*< reference to the input */
   SquareMatrix m_estimatedScores; /*< matrix of future costs for contiguous parts (span) of the input */
@@ -115,6 +119,17 @@ protected:
 
   void GetTargetPhraseCollectionBatch();
 
+  //! threads creating translation options. 1 unless the subclass allows spans to be done in parallel
+  virtual size_t GetNumTranslationOptionThreads() const {
+    return 1;
+  }
+
+  //! translation options for all spans starting at sPos, from all decoding graphs
+  void CreateTranslationOptionsForStart(size_t sPos);
+
+  //! thread worker. Starts first, first + step, ...
+  void CreateTranslationOptionsForStarts(size_t first, size_t step, Arena *arena, std::string *error);
+
   bool CreateTranslationOptionsForRange(
     const DecodeGraph &decodeGraph
     , size_t startPos
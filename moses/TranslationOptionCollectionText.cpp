@@ -165,6 +165,13 @@ InputPath &TranslationOptionCollectionText::GetInputPath(size_t startPos, size_t
   return *m_inputPathMatrix[startPos][offset];
 }
 
+size_t TranslationOptionCollectionText::GetNumTranslationOptionThreads() const
+{
+  // phrase table lookups are done beforehand by
+  // GetTargetPhraseCollectionBatch(), on this thread
+  return m_ttask.lock()->options()->search.trans_opt_threads;
+}
+
 void TranslationOptionCollectionText::CreateTranslationOptions()
 {
   GetTargetPhraseCollectionBatch();
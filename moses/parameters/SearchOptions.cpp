@@ -13,8 +13,10 @@ namespace Moses
     , max_phrase_length(DEFAULT_MAX_PHRASE_LENGTH)
     , max_trans_opt_per_cov(DEFAULT_MAX_TRANS_OPT_SIZE)
     , max_partial_trans_opt(DEFAULT_MAX_PART_TRANS_OPT_SIZE)
+    , trans_opt_threads(1)
     , beam_width(DEFAULT_BEAM_WIDTH)
     , timeout(0)
+    , segment_timeout(0)
     , consensus(false)
     , early_discarding_threshold(DEFAULT_EARLY_DISCARDING_THRESHOLD)
     , trans_opt_threshold(DEFAULT_TRANSLATION_OPTION_THRESHOLD)
@@ -38,7 +40,7 @@ namespace Moses
     param.SetParameter(early_discarding_threshold, "early-discarding-threshold", 
                        DEFAULT_EARLY_DISCARDING_THRESHOLD);
     param.SetParameter(timeout, "time-out", 0);
-    param.SetParameter(segment_timeout, "segment-time-out", 0);
+    param.SetParameter(segment_timeout, "segment-time-out", 0.0);
     param.SetParameter(max_phrase_length, "max-phrase-length", 
                        DEFAULT_MAX_PHRASE_LENGTH);
     param.SetParameter(trans_opt_threshold, "translation-option-threshold", 
@@ -47,6 +49,8 @@ namespace Moses
                        DEFAULT_MAX_TRANS_OPT_SIZE);
     param.SetParameter(max_partial_trans_opt, "max-partial-trans-opt", 
                        DEFAULT_MAX_PART_TRANS_OPT_SIZE);
+    param.SetParameter(trans_opt_threads, "translation-option-threads", 
+                       size_t(1));
 
     param.SetParameter(consensus, "consensus-decoding", false);
     param.SetParameter(disable_discarding, "disable-discarding", false);
@@ -96,6 +100,11 @@ namespace Moses
 
       si = params.find("time-out");
       if (si != params.end()) timeout = xmlrpc_c::value_int(si->second);
+
+      // per request in milliseconds, like moses2's time budget
+      si = params.find("segment-time-out-ms");
+      if (si != params.end()) 
+        segment_timeout = xmlrpc_c::value_int(si->second) / 1000.0;
       
       si = params.find("max-phrase-length");
       if (si != params.end()) max_phrase_length = xmlrpc_c::value_int(si->second);
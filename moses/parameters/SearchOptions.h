@@ -21,11 +21,12 @@ namespace Moses
     size_t max_phrase_length;
     size_t max_trans_opt_per_cov; 
     size_t max_partial_trans_opt;
+    size_t trans_opt_threads; // threads building the options of 1 sentence
     // beam search
     float beam_width;
 
     int timeout;
-    int segment_timeout;
+    double segment_timeout; // seconds, fractions allowed
 
     bool consensus; //! Use Consensus decoding  (DeNero et al 2009)
     
@@ -46,6 +46,9 @@ ServerOptions()
   , keepaliveTimeout(15)
   , keepaliveMaxConn(30)
   , timeout(15)
+  , maxQueue(0)
+  , requestTimeout(0)
+  , resultTimeout(600)
 { }
 
 ServerOptions::
@@ -72,6 +75,11 @@ init(Parameter const& P)
   P.SetParameter(this->keepaliveMaxConn,"server-keepalive-maxconn", 30);
   P.SetParameter(this->timeout,"server-timeout",15);
 
+  // admission control and time limits of translation requests
+  P.SetParameter(this->maxQueue, "server-max-queue", size_t(0));
+  P.SetParameter(this->requestTimeout, "server-request-timeout", 0.0);
+  P.SetParameter(this->resultTimeout, "server-result-timeout", 600.0);
+
   // the stuff below is related to Moses translation sessions
   std::string timeout_spec;
   P.SetParameter(timeout_spec, "session-timeout",std::string("30m"));
@@ -21,6 +21,10 @@ namespace Moses
     int keepaliveTimeout;  // this is for the abyss server
     int keepaliveMaxConn;  // this is for the abyss server
     int timeout;           // this is for the abyss server
+
+    size_t maxQueue;       // sentences queued or being decoded, 0 = no limit
+    double requestTimeout; // seconds until a request is answered, 0 = no limit
+    double resultTimeout;  // seconds an async result waits to be collected, 0 = forever
     
     bool init(Parameter const& param);
     ServerOptions(Parameter const& param);
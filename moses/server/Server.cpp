@@ -10,9 +10,12 @@ namespace MosesServer
       m_updater(new Updater),
       m_optimizer(new Optimizer),
       m_translator(new Translator(*this)),
+      m_result(new TranslationResult(*static_cast<Translator*>(m_translator.get()))),
       m_close_session(new CloseSession(*this))
   {
     m_registry.addMethod("translate", m_translator);
+    m_registry.addMethod("translate_batch", m_translator);
+    m_registry.addMethod("translate_result", m_result);
     m_registry.addMethod("updater",   m_updater);
     m_registry.addMethod("optimize",  m_optimizer);
     m_registry.addMethod("close_session", m_close_session);
@@ -28,6 +28,7 @@ namespace MosesServer
     xmlrpc_c::methodPtr const m_updater;
     xmlrpc_c::methodPtr const m_optimizer;
     xmlrpc_c::methodPtr const m_translator;
+    xmlrpc_c::methodPtr const m_result;
     xmlrpc_c::methodPtr const m_close_session;
     std::string m_pidfile;
   public:
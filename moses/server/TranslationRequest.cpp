@@ -4,6 +4,7 @@
 #include <boost/foreach.hpp>
 #include "moses/Util.h"
 #include "moses/Hypothesis.h"
+#include "util/usage.hh"
 
 namespace MosesServer
 {
@@ -31,10 +32,10 @@ using Moses::Scan;
 boost::shared_ptr<TranslationRequest>
 TranslationRequest::
 create(Translator* translator, xmlrpc_c::paramList const& paramList,
-       boost::condition_variable& cond, boost::mutex& mut)
+       boost::shared_ptr<TranslationJob> const& job, double deadline)
 {
   boost::shared_ptr<TranslationRequest> ret;
-  ret.reset(new TranslationRequest(paramList, cond, mut));
+  ret.reset(new TranslationRequest(paramList, job, deadline));
   ret->m_self = ret;
   ret->m_translator = translator;
   return ret;
@@ -55,28 +56,48 @@ void
 TranslationRequest::
 Run()
 {
-  typedef std::map<std::string,xmlrpc_c::value> param_t;
-  param_t const& params = m_paramList.getStruct(0);
-  parse_request(params);
-  // cerr << "SESSION ID" << ret->m_session_id << endl;
+  // the job waits for every task, so this must finish it whatever
+  // happens here
+  try 
+    {
+      if (m_deadline > 0 && util::WallTime() >= m_deadline)
+        throw xmlrpc_c::fault("Request timed out before decoding started",
+                              xmlrpc_c::fault::CODE_TIMEOUT);
 
+      typedef std::map<std::string,xmlrpc_c::value> param_t;
+      param_t const& params = m_paramList.getStruct(0);
+      parse_request(params);
+      // cerr << "SESSION ID" << ret->m_session_id << endl;
 
-  // settings within the session scope
-  param_t::const_iterator si = params.find("context-weights");
-  if (si != params.end()) SetContextWeights(*m_scope, si->second);
-  
-  Moses::StaticData const& SD = Moses::StaticData::Instance();
 
-  if (is_syntax(m_options->search.algo))
-    run_chart_decoder();
-  else
-    run_phrase_decoder();
+      // settings within the session scope
+      param_t::const_iterator si = params.find("context-weights");
+      if (si != params.end()) SetContextWeights(*m_scope, si->second);
+  
+      if (is_syntax(m_options->search.algo))
+        run_chart_decoder();
+      else
+        run_phrase_decoder();
+
+      // the search gave up early and returned the best it had
+      if (m_deadline > 0 && util::WallTime() >= m_deadline)
+        m_retData["timed-out"] = xmlrpc_c::value_boolean(true);
+    }
+  catch (xmlrpc_c::fault const& e)
+    {
+      m_error = e.getDescription();
+      m_error_code = e.getCode();
+    }
+  catch (std::exception const& e)
+    {
+      m_error = e.what();
+      m_error_code = xmlrpc_c::fault::CODE_INTERNAL;
+    }
 
-  {
-    boost::lock_guard<boost::mutex> lock(m_mutex);
-    m_done = true;
-  }
-  m_cond.notify_one();
+  // the job holds this task, so don't keep the job alive in turn
+  boost::shared_ptr<TranslationJob> job;
+  job.swap(m_job);
+  job->finished();
 
 }
 
@@ -210,7 +231,7 @@ insertTranslationOptions(Moses::Manager& manager,
         toptXml["start"]  = xmlrpc_c::value_int(s);
         toptXml["end"]    = xmlrpc_c::value_int(e);
         vector<xmlrpc_c::value> scoresXml;
-        const std::valarray<FValue> &scores
+        const Moses::FCoreVector &scores
 	  = topt->GetScoreBreakdown().getCoreFeatures();
         for (size_t j = 0; j < scores.size(); ++j)
           scoresXml.push_back(xmlrpc_c::value_double(scores[j]));
@@ -227,8 +248,10 @@ insertTranslationOptions(Moses::Manager& manager,
 
 TranslationRequest::
 TranslationRequest(xmlrpc_c::paramList const& paramList,
-                   boost::condition_variable& cond, boost::mutex& mut)
-  : m_cond(cond), m_mutex(mut), m_done(false), m_paramList(paramList)
+                   boost::shared_ptr<TranslationJob> const& job,
+                   double deadline)
+  : m_job(job), m_deadline(deadline)
+  , m_error_code(xmlrpc_c::fault::CODE_UNSPECIFIED), m_paramList(paramList)
   , m_session_id(0)
 { 
 
@@ -276,6 +299,14 @@ parse_request(std::map<std::string, xmlrpc_c::value> const& params)
   boost::shared_ptr<Moses::AllOptions> opts(new Moses::AllOptions(*StaticData::Instance().options()));
   opts->update(params);
 
+  // stop the search when the request runs out of time
+  if (m_deadline > 0) 
+    {
+      double left = std::max(0.001, m_deadline - util::WallTime());
+      if (opts->search.segment_timeout <= 0 || left < opts->search.segment_timeout)
+        opts->search.segment_timeout = left;
+    }
+
   m_withGraphInfo = check(params, "sg");
   if (m_withGraphInfo || opts->nbest.nbest_size > 0) {
     opts->output.SearchGraph = "true";
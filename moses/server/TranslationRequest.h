@@ -28,11 +28,12 @@ namespace MosesServer
 class
 TranslationRequest : public virtual Moses::TranslationTask
 {
-  boost::condition_variable& m_cond;
-  boost::mutex& m_mutex;
-  bool m_done;
+  boost::shared_ptr<TranslationJob> m_job; // until Run() has finished
+  double m_deadline; // wall time by which the reply is due, 0 means none
+  std::string m_error; // why the request failed, empty if it didn't
+  xmlrpc_c::fault::code_t m_error_code;
 
-  xmlrpc_c::paramList const& m_paramList;
+  xmlrpc_c::paramList const m_paramList; // a copy, async jobs outlive the call
   std::map<std::string, xmlrpc_c::value> m_retData;
   std::map<uint32_t,float> m_bias; // for biased sampling
 
@@ -91,8 +92,8 @@ TranslationRequest : public virtual Moses::TranslationTask
                            std::map<std::string, xmlrpc_c::value>& retData);
 protected:
   TranslationRequest(xmlrpc_c::paramList const& paramList,
-                     boost::condition_variable& cond,
-                     boost::mutex& mut);
+                     boost::shared_ptr<TranslationJob> const& job,
+                     double deadline);
 
 public:
 
@@ -100,8 +101,8 @@ public:
   boost::shared_ptr<TranslationRequest>
   create(Translator* translator,
 	 xmlrpc_c::paramList const& paramList,
-         boost::condition_variable& cond,
-         boost::mutex& mut);
+         boost::shared_ptr<TranslationJob> const& job,
+         double deadline = 0);
 
 
   virtual bool
@@ -109,16 +110,21 @@ public:
     return false;
   }
 
-  bool
-  IsDone() const {
-    return m_done;
-  }
-
   std::map<std::string, xmlrpc_c::value> const&
-  GetRetData() {
+  GetRetData() const {
     return m_retData;
   }
 
+  std::string const&
+  GetError() const {
+    return m_error;
+  }
+
+  xmlrpc_c::fault::code_t
+  GetErrorCode() const {
+    return m_error_code;
+  }
+
   void
   Run();
 
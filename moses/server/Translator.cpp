@@ -3,6 +3,8 @@
 #include "Translator.h"
 #include "TranslationRequest.h"
 #include "Server.h"
+#include "util/usage.hh"
+#include <sstream>
 
 namespace MosesServer
 {
@@ -13,13 +15,127 @@ using namespace Moses;
 Translator::
 Translator(Server& server)
   : m_server(server),
-    m_threadPool(server.options().numThreads)
+    m_threadPool(server.options().numThreads),
+    m_num_admitted(0),
+    m_next_job_id(1)
 {
   // signature and help strings are documentation -- the client
   // can query this information with a system.methodSignature and
   // system.methodHelp RPC.
   this->_signature = "S:S";
-  this->_help = "Does translation";
+  this->_help = "Does translation. Give an array of sentences as 'text' "
+    "to translate them as a batch";
+}
+
+void
+Translator::
+admit(size_t const n)
+{
+  size_t const limit = m_server.options().maxQueue;
+  boost::lock_guard<boost::mutex> lock(m_admission_lock);
+  if (limit && m_num_admitted + n > limit) 
+    {
+      ostringstream msg;
+      msg << "Server busy: " << m_num_admitted << " sentences queued, limit is " 
+          << limit;
+      throw xmlrpc_c::fault(msg.str(), xmlrpc_c::fault::CODE_LIMIT_EXCEEDED);
+    }
+  m_num_admitted += n;
+}
+
+void
+Translator::
+release(size_t const n)
+{
+  boost::lock_guard<boost::mutex> lock(m_admission_lock);
+  m_num_admitted -= n;
+}
+
+TranslationJob::
+TranslationJob(Translator& translator, size_t const size, bool const batch)
+  : m_translator(translator), m_size(size), m_batch(batch)
+  , m_pending(size), m_finish_time(0)
+{
+  m_translator.admit(m_size);
+}
+
+TranslationJob::
+~TranslationJob()
+{
+  // tasks that were never created can't finish the job
+  if (m_pending) m_translator.release(m_size);
+}
+
+void
+TranslationJob::
+finished()
+{
+  bool done;
+  {
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    done = (--m_pending == 0);
+    if (done) m_finish_time = util::WallTime();
+  }
+  if (done) 
+    {
+      m_translator.release(m_size);
+      m_cond.notify_all();
+    }
+}
+
+bool
+TranslationJob::
+is_done()
+{
+  boost::lock_guard<boost::mutex> lock(m_lock);
+  return m_pending == 0;
+}
+
+void
+TranslationJob::
+wait()
+{
+  boost::unique_lock<boost::mutex> lock(m_lock);
+  while (m_pending) m_cond.wait(lock);
+}
+
+double
+TranslationJob::
+finish_time()
+{
+  boost::lock_guard<boost::mutex> lock(m_lock);
+  return m_finish_time;
+}
+
+void
+TranslationJob::
+reply(xmlrpc_c::value * const retvalP) const
+{
+  typedef std::map<std::string, xmlrpc_c::value> params_t;
+  if (!m_batch) 
+    {
+      TranslationRequest const& task = *tasks[0];
+      if (task.GetError().size())
+        throw xmlrpc_c::fault(task.GetError(), task.GetErrorCode());
+      *retvalP = xmlrpc_c::value_struct(task.GetRetData());
+      return;
+    }
+
+  // a failed sentence doesn't fail the batch; it reports its error instead
+  vector<xmlrpc_c::value> translations(tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i) 
+    {
+      if (tasks[i]->GetError().size()) 
+        {
+          params_t err;
+          err["error"] = xmlrpc_c::value_string(tasks[i]->GetError());
+          translations[i] = xmlrpc_c::value_struct(err);
+        }
+      else translations[i] = xmlrpc_c::value_struct(tasks[i]->GetRetData());
+    }
+  params_t ret;
+  ret["translations"] = xmlrpc_c::value_array(translations);
+  *retvalP = xmlrpc_c::value_struct(ret);
 }
 
 void
@@ -27,15 +143,138 @@ Translator::
 execute(xmlrpc_c::paramList const& paramList,
         xmlrpc_c::value *   const  retvalP)
 {
-  boost::condition_variable cond;
-  boost::mutex mut;
-  boost::shared_ptr<TranslationRequest> task;
-  task = TranslationRequest::create(this, paramList,cond,mut);
-  m_threadPool.Submit(task);
-  boost::unique_lock<boost::mutex> lock(mut);
-  while (!task->IsDone())
-    cond.wait(lock);
-  *retvalP = xmlrpc_c::value_struct(task->GetRetData());
+  typedef std::map<std::string, xmlrpc_c::value> params_t;
+  params_t const params = paramList.getStruct(0);
+  params_t::const_iterator si = params.find("text");
+  bool const batch = (si != params.end() 
+                      && si->second.type() == xmlrpc_c::value::TYPE_ARRAY);
+
+  // one parameter list per sentence
+  vector<xmlrpc_c::paramList> requests;
+  if (batch) 
+    {
+      vector<xmlrpc_c::value> const texts 
+        = xmlrpc_c::value_array(si->second).vectorValueValue();
+      requests.resize(texts.size());
+      for (size_t i = 0; i < texts.size(); ++i) 
+        {
+          params_t p = params;
+          p["text"] = texts[i];
+          requests[i].add(xmlrpc_c::value_struct(p));
+        }
+    }
+  else requests.push_back(paramList);
+
+  bool async = false;
+  si = params.find("async");
+  if (si != params.end()) async = xmlrpc_c::value_boolean(si->second);
+
+  // Clients may ask for less time than the server allows. All parameters
+  // are checked before the job is admitted, so a bad one can't hold a
+  // place in the queue.
+  double timeout = m_server.options().requestTimeout;
+  si = params.find("timeout");
+  if (si != params.end()) 
+    {
+      double t;
+      if (si->second.type() == xmlrpc_c::value::TYPE_INT)
+        t = xmlrpc_c::value_int(si->second);
+      else if (si->second.type() == xmlrpc_c::value::TYPE_DOUBLE)
+        t = xmlrpc_c::value_double(si->second);
+      else
+        throw xmlrpc_c::fault("timeout must be a number of seconds",
+                              xmlrpc_c::fault::CODE_PARSE);
+      if (t > 0 && (timeout <= 0 || t < timeout)) timeout = t;
+    }
+
+  boost::shared_ptr<TranslationJob> job
+    (new TranslationJob(*this, requests.size(), batch));
+
+  // the request timeout counts from admission, so it includes the wait
+  // in the queue
+  double const deadline = timeout > 0 ? util::WallTime() + timeout : 0;
+
+  size_t submitted = 0;
+  try 
+    {
+      job->tasks.resize(requests.size());
+      for (size_t i = 0; i < requests.size(); ++i) 
+        job->tasks[i] = TranslationRequest::create(this, requests[i], job, deadline);
+      for (; submitted < requests.size(); ++submitted)
+        m_threadPool.Submit(job->tasks[submitted]);
+    }
+  catch (...)
+    {
+      // the tasks already queued still run and finish the job; the
+      // others never will. Dropping them also drops their hold on the job.
+      job->tasks.resize(submitted);
+      for (size_t i = submitted; i < requests.size(); ++i)
+        job->finished();
+      throw;
+    }
+
+  if (async) 
+    {
+      drop_expired_jobs();
+      params_t ret;
+      {
+        boost::lock_guard<boost::mutex> lock(m_jobs_lock);
+        uint64_t const id = m_next_job_id++;
+        m_jobs[id] = job;
+        ret["job-id"] = xmlrpc_c::value_int(id);
+      }
+      *retvalP = xmlrpc_c::value_struct(ret);
+      return;
+    }
+
+  job->wait();
+  job->reply(retvalP);
+}
+
+void
+Translator::
+collect(uint64_t const job_id, xmlrpc_c::value * const retvalP)
+{
+  drop_expired_jobs();
+
+  boost::shared_ptr<TranslationJob> job;
+  {
+    boost::lock_guard<boost::mutex> lock(m_jobs_lock);
+    std::map<uint64_t, boost::shared_ptr<TranslationJob> >::iterator m 
+      = m_jobs.find(job_id);
+    if (m == m_jobs.end())
+      throw xmlrpc_c::fault("Unknown job id, or its result has already been "
+                            "collected or dropped", xmlrpc_c::fault::CODE_INDEX);
+    if (!m->second->is_done()) 
+      {
+        std::map<std::string, xmlrpc_c::value> ret;
+        ret["job-id"] = xmlrpc_c::value_int(job_id);
+        ret["pending"] = xmlrpc_c::value_boolean(true);
+        *retvalP = xmlrpc_c::value_struct(ret);
+        return;
+      }
+    job = m->second;
+    m_jobs.erase(m);
+  }
+  job->reply(retvalP);
+}
+
+void
+Translator::
+drop_expired_jobs()
+{
+  double const expiry = m_server.options().resultTimeout;
+  if (expiry <= 0) return;
+  double const now = util::WallTime();
+  boost::lock_guard<boost::mutex> lock(m_jobs_lock);
+  std::map<uint64_t, boost::shared_ptr<TranslationJob> >::iterator m 
+    = m_jobs.begin();
+  while (m != m_jobs.end())
+    {
+      double const finished = m->second->finish_time();
+      if (finished > 0 && now - finished > expiry) m_jobs.erase(m++);
+      else ++m;
+    }
 }
 
 Session const& 
@@ -45,4 +284,26 @@ get_session(uint64_t const id)
   return m_server.get_session(id);
 }
 
+TranslationResult::
+TranslationResult(Translator& translator)
+  : m_translator(translator)
+{
+  this->_signature = "S:S";
+  this->_help = "Returns the result of an async translate call, given its "
+    "'job-id', or 'pending' if it isn't finished";
+}
+
+void
+TranslationResult::
+execute(xmlrpc_c::paramList const& paramList,
+        xmlrpc_c::value *   const  retvalP)
+{
+  typedef std::map<std::string, xmlrpc_c::value> params_t;
+  params_t const params = paramList.getStruct(0);
+  params_t::const_iterator si = params.find("job-id");
+  if (si == params.end())
+    throw xmlrpc_c::fault("Missing job id", xmlrpc_c::fault::CODE_PARSE);
+  m_translator.collect(xmlrpc_c::value_int(si->second), retvalP);
+}
+
 }
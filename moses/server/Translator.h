@@ -6,6 +6,9 @@
 #include <xmlrpc-c/base.hpp>
 #include <xmlrpc-c/registry.hpp>
 #include <xmlrpc-c/server_abyss.hpp>
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <vector>
 #ifndef WITH_THREADS
 #pragma message("COMPILING WITHOUT THREADS!")
 #else
@@ -15,6 +18,42 @@ namespace MosesServer
 {
 
   class Server;
+  class Translator;
+  class TranslationRequest;
+
+  // The sentences of one request. Each task holds the job until it has
+  // finished, so the job outlives the call that made it, even if that
+  // call threw or returned at once. Keeps its sentences admitted until
+  // the last of them is done.
+  class
+  TranslationJob
+  {
+    Translator& m_translator;
+    size_t m_size;
+    bool m_batch;
+    size_t m_pending;
+    double m_finish_time;
+    boost::mutex m_lock;
+    boost::condition_variable m_cond;
+  public:
+    TranslationJob(Translator& translator, size_t size, bool batch);
+    ~TranslationJob();
+
+    std::vector<boost::shared_ptr<TranslationRequest> > tasks;
+
+    // a task has finished, or will never run
+    void finished();
+
+    bool is_done();
+    void wait();
+
+    // wall time at which the last task finished, 0 while any are left
+    double finish_time();
+
+    // The reply for a finished job. A single sentence's error is thrown
+    // as a fault; a batch reports errors per sentence.
+    void reply(xmlrpc_c::value * const retvalP) const;
+  };
 
   class
   Translator : public xmlrpc_c::method
@@ -23,13 +62,54 @@ namespace MosesServer
     // Moses::ServerOptions m_server_options;
   public:
     Translator(Server& server);
-    
+
+    // A request whose "text" is an array of sentences is a batch: the
+    // sentences are decoded side by side on the thread pool and the
+    // results come back in the same order under "translations".
+    // With "async" set the call returns a "job-id" at once, without
+    // waiting for the translation; the reply is fetched with
+    // translate_result.
     void execute(xmlrpc_c::paramList const& paramList,
 		 xmlrpc_c::value *   const  retvalP);
-    
+
+    // the reply of an async job, or "pending" if it isn't finished
+    void collect(uint64_t job_id, xmlrpc_c::value * const retvalP);
+
     Session const& get_session(uint64_t session_id);
   private:
+    friend class TranslationJob;
+
     Moses::ThreadPool m_threadPool;
+
+    // Sentences queued or being decoded. Requests that would take this
+    // above server-max-queue are turned away at once rather than left
+    // waiting on a connection thread.
+    boost::mutex m_admission_lock;
+    size_t m_num_admitted;
+
+    void admit(size_t n);
+    void release(size_t n);
+
+    // Async jobs by id, until their reply is collected. Replies nobody
+    // collects are dropped server-result-timeout seconds after they
+    // finished.
+    boost::mutex m_jobs_lock;
+    uint64_t m_next_job_id;
+    std::map<uint64_t, boost::shared_ptr<TranslationJob> > m_jobs;
+
+    void drop_expired_jobs();
+  };
+
+  // translate_result: takes the "job-id" that an async translate returned
+  class
+  TranslationResult : public xmlrpc_c::method
+  {
+    Translator& m_translator;
+  public:
+    TranslationResult(Translator& translator);
+
+    void execute(xmlrpc_c::paramList const& paramList,
+		 xmlrpc_c::value *   const  retvalP);
   };
 
 }
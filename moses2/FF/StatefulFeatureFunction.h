@@ -56,6 +56,12 @@ public:
     const System &system,
     const Batch &batch) const;
 
+  // if true, EvaluateWhenApplied() must not be called from several threads
+  // for the same manager
+  virtual bool AllocatesFromManagerPool() const {
+    return false;
+  }
+
 protected:
   size_t m_statefulInd;
 
@@ -19,7 +19,10 @@ namespace Moses2
 {
 
 HypothesisColl::HypothesisColl(const ManagerBase &mgr)
-  :m_coll(MemPoolAllocator<const HypothesisBase*>(mgr.GetPool()))
+  :m_pool(mgr.GetPool())
+  ,m_slots(NULL)
+  ,m_mask(0)
+  ,m_size(0)
   ,m_sortedHypos(NULL)
 {
   m_bestScore = -std::numeric_limits<float>::infinity();
@@ -37,8 +40,9 @@ const HypothesisBase *HypothesisColl::GetBestHypo() const
 
   SCORE bestScore = -std::numeric_limits<SCORE>::infinity();
   const HypothesisBase *bestHypo;
-  BOOST_FOREACH(const HypothesisBase *hypo, m_coll) {
-    if (hypo->GetFutureScore() > bestScore) {
+  for (size_t i = 0; i <= m_mask; ++i) {
+    const HypothesisBase *hypo = m_slots[i].hypo;
+    if (hypo && hypo->GetFutureScore() > bestScore) {
       bestScore = hypo->GetFutureScore();
       bestHypo = hypo;
     }
@@ -105,18 +109,65 @@ void HypothesisColl::Add(
   }
 }
 
+size_t HypothesisColl::Find(const HypothesisBase &hypo, size_t hash) const
+{
+  size_t ind = hash & m_mask;
+  while (m_slots[ind].hypo
+         && (m_slots[ind].hash != hash || !(*m_slots[ind].hypo == hypo))) {
+    ind = (ind + 1) & m_mask;
+  }
+  return ind;
+}
+
+size_t HypothesisColl::FindEmpty(size_t hash) const
+{
+  size_t ind = hash & m_mask;
+  while (m_slots[ind].hypo) {
+    ind = (ind + 1) & m_mask;
+  }
+  return ind;
+}
+
+void HypothesisColl::Grow()
+{
+  Slot *oldSlots = m_slots;
+  size_t oldCapacity = m_slots ? m_mask + 1 : 0;
+
+  size_t capacity = oldCapacity ? oldCapacity * 2 : 64;
+  m_slots = m_pool.Allocate<Slot>(capacity);
+  m_mask = capacity - 1;
+  for (size_t i = 0; i < capacity; ++i) {
+    m_slots[i].hypo = NULL;
+  }
+
+  for (size_t i = 0; i < oldCapacity; ++i) {
+    if (oldSlots[i].hypo) {
+      m_slots[FindEmpty(oldSlots[i].hash)] = oldSlots[i];
+    }
+  }
+}
+
 StackAdd HypothesisColl::Add(const HypothesisBase *hypo)
 {
-  std::pair<_HCType::iterator, bool> addRet = m_coll.insert(hypo);
+  // at most half full
+  if (m_slots == NULL || 2 * (m_size + 1) > m_mask + 1) {
+    Grow();
+  }
+
+  size_t hash = hypo->hash();
+  Slot &slot = m_slots[Find(*hypo, hash)];
   //cerr << endl << "new=" << hypo->Debug(hypo->GetManager().system) << endl;
 
   // CHECK RECOMBINATION
-  if (addRet.second) {
+  if (slot.hypo == NULL) {
     // equiv hypo doesn't exists
     //cerr << "Added " << hypo << endl;
+    slot.hash = hash;
+    slot.hypo = hypo;
+    ++m_size;
     return StackAdd(true, NULL);
   } else {
-    HypothesisBase *hypoExisting = const_cast<HypothesisBase*>(*addRet.first);
+    HypothesisBase *hypoExisting = const_cast<HypothesisBase*>(slot.hypo);
     //cerr << "hypoExisting=" << hypoExisting->Debug(hypo->GetManager().system) << endl;
 
     if (hypo->GetFutureScore() > hypoExisting->GetFutureScore()) {
@@ -125,29 +176,7 @@ StackAdd HypothesisColl::Add(const HypothesisBase *hypo)
 	  //	  << " discard existing " << hypoExisting << "(" << hypoExisting->hash() << ")"
 	  //	  << endl;
 
-      const HypothesisBase * const &hypoExisting1 = *addRet.first;
-      const HypothesisBase *&hypoExisting2 =
-        const_cast<const HypothesisBase *&>(hypoExisting1);
-      hypoExisting2 = hypo;
-
-      /*
-      Delete(hypoExisting);
-      addRet = m_coll.insert(hypo);
-      UTIL_THROW_IF2(!addRet.second, "couldn't insert hypo "
-      		  	  	  << hypo << "(" << hypo->hash() << ")");
-      */
-      /*
-      if (!addRet.second) {
-    	  cerr << "couldn't insert hypo " << hypo << "(" << hypo->hash() << ")" << endl;
-    	  cerr << "m_coll=";
-    	  for (_HCType::const_iterator iter = m_coll.begin(); iter != m_coll.end(); ++iter) {
-    		  const HypothesisBase *h = *iter;
-    		  cerr << h << "(" << h->hash() << ") ";
-    	  }
-    	  cerr << endl;
-    	  abort();
-      }
-	  */
+      slot.hypo = hypo;
 
       return StackAdd(true, hypoExisting);
     } else {
@@ -170,7 +199,7 @@ const Hypotheses &HypothesisColl::GetSortedAndPrunedHypos(
     // create sortedHypos first
     MemPool &pool = mgr.GetPool();
     m_sortedHypos = new (pool.Allocate<Hypotheses>()) Hypotheses(pool,
-        m_coll.size());
+        m_size);
 
     SortHypos(mgr, m_sortedHypos->GetArray());
 
@@ -234,15 +263,19 @@ void HypothesisColl::SortHypos(const ManagerBase &mgr, const HypothesisBase **so
 
   /*
    cerr << "UNSORTED hypos: ";
-   BOOST_FOREACH(const HypothesisBase *hypo, m_coll) {
-     cerr << hypo << "(" << hypo->GetFutureScore() << ")" << " ";
+   for (size_t i = 0; i <= m_mask; ++i) {
+     const HypothesisBase *hypo = m_slots[i].hypo;
+     if (hypo) cerr << hypo << "(" << hypo->GetFutureScore() << ")" << " ";
    }
    cerr << endl;
    */
   size_t ind = 0;
-  BOOST_FOREACH(const HypothesisBase *hypo, m_coll) {
-    sortedHypos[ind] = hypo;
-    ++ind;
+  for (size_t i = 0; ind < m_size; ++i) {
+    const HypothesisBase *hypo = m_slots[i].hypo;
+    if (hypo) {
+      sortedHypos[ind] = hypo;
+      ++ind;
+    }
   }
 
   size_t indMiddle;
@@ -276,16 +309,37 @@ void HypothesisColl::SortHypos(const ManagerBase &mgr, const HypothesisBase **so
 void HypothesisColl::Delete(const HypothesisBase *hypo)
 {
   //cerr << " Delete hypo=" << hypo << "(" << hypo->hash() << ")"
-  //		<< " m_coll=" << m_coll.size() << endl;
+  //		<< " m_coll=" << m_size << endl;
 
-  size_t erased = m_coll.erase(hypo);
-  UTIL_THROW_IF2(erased != 1, "couldn't erase hypo " << hypo);
+  // by pointer: an equal hypo may be stored in its place
+  UTIL_THROW_IF2(m_slots == NULL, "couldn't erase hypo " << hypo);
+  size_t ind = hypo->hash() & m_mask;
+  while (m_slots[ind].hypo && m_slots[ind].hypo != hypo) {
+    ind = (ind + 1) & m_mask;
+  }
+  UTIL_THROW_IF2(m_slots[ind].hypo != hypo, "couldn't erase hypo " << hypo);
+
+  // backward-shift deletion. Move later entries of the probe sequence into
+  // the hole unless they're already at, or probing from, a later position
+  size_t hole = ind;
+  for (size_t i = (hole + 1) & m_mask; m_slots[i].hypo; i = (i + 1) & m_mask) {
+    size_t ideal = m_slots[i].hash & m_mask;
+    if (((i - ideal) & m_mask) >= ((i - hole) & m_mask)) {
+      m_slots[hole] = m_slots[i];
+      hole = i;
+    }
+  }
+  m_slots[hole].hypo = NULL;
+  --m_size;
 }
 
 void HypothesisColl::Clear()
 {
   m_sortedHypos = NULL;
-  m_coll.clear();
+  for (size_t i = 0; m_slots && i <= m_mask; ++i) {
+    m_slots[i].hypo = NULL;
+  }
+  m_size = 0;
 
   m_bestScore = -std::numeric_limits<float>::infinity();
   m_worstScore = std::numeric_limits<float>::infinity();
@@ -294,7 +348,9 @@ void HypothesisColl::Clear()
 std::string HypothesisColl::Debug(const System &system) const
 {
   stringstream out;
-  BOOST_FOREACH (const HypothesisBase *hypo, m_coll) {
+  for (size_t i = 0; m_slots && i <= m_mask; ++i) {
+    const HypothesisBase *hypo = m_slots[i].hypo;
+    if (hypo == NULL) continue;
     out << hypo->Debug(system);
     out << std::endl << std::endl;
   }
@@ -5,7 +5,6 @@
  *      Author: hieu
  */
 #pragma once
-#include <boost/unordered_set.hpp>
 #include "HypothesisBase.h"
 #include "MemPoolAllocator.h"
 #include "Recycler.h"
@@ -32,7 +31,7 @@ public:
            ArcLists &arcLists);
 
   size_t GetSize() const {
-    return m_coll.size();
+    return m_size;
   }
 
   void Clear();
@@ -54,11 +53,22 @@ public:
   std::string Debug(const System &system) const;
 
 protected:
-  typedef boost::unordered_set<const HypothesisBase*,
-		  UnorderedComparer<HypothesisBase>, UnorderedComparer<HypothesisBase>,
-          MemPoolAllocator<const HypothesisBase*> > _HCType;
+  /** Open-addressing recombination table, linear probing. Each slot keeps
+   * the hypo's state hash, computed once per hypo, so probing only
+   * dereferences hypos whose hash matches. Those are compared with
+   * operator== before being recombined, so a hash collision doesn't merge
+   * hypos with different states
+   */
+  struct Slot {
+    size_t hash;
+    const HypothesisBase *hypo;
+  };
+
+  MemPool &m_pool;
+  Slot *m_slots;
+  size_t m_mask; // capacity - 1. capacity is a power of 2
+  size_t m_size;
 
-  _HCType m_coll;
   mutable Hypotheses *m_sortedHypos;
 
   SCORE m_bestScore;
@@ -66,6 +76,12 @@ protected:
 
   StackAdd Add(const HypothesisBase *hypo);
 
+  // slot holding a hypo equal to hypo, or the empty slot where it would go
+  size_t Find(const HypothesisBase &hypo, size_t hash) const;
+  // 1st empty slot for the hash. For rehashing, where all hypos differ
+  size_t FindEmpty(size_t hash) const;
+  void Grow();
+
   void PruneHypos(const ManagerBase &mgr, ArcLists &arcLists);
   void SortHypos(const ManagerBase &mgr, const HypothesisBase **sortedHypos) const;
 
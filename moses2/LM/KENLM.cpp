@@ -111,11 +111,21 @@ KENLM<Model>::KENLM(size_t startInd, const std::string &line,
                     const std::string &file, FactorType factorType,
                     util::LoadMethod load_method) :
   StatefulFeatureFunction(startInd, line), m_path(file), m_factorType(
-    factorType), m_load_method(load_method)
+    factorType), m_load_method(load_method), m_numaReplicas(false)
 {
   ReadParameters();
 }
 
+template<class Model>
+void KENLM<Model>::SetParameter(const std::string& key, const std::string& value)
+{
+  if (key == "numa-replicas") {
+    m_numaReplicas = Scan<bool>(value);
+  } else {
+    StatefulFeatureFunction::SetParameter(key, value);
+  }
+}
+
 template<class Model>
 KENLM<Model>::~KENLM()
 {
@@ -138,7 +148,22 @@ void KENLM<Model>::Load(System &system)
   config.enumerate_vocab = &builder;
   config.load_method = m_load_method;
 
-  m_ngram.reset(new Model(m_path.c_str(), config));
+  if (!m_numaReplicas || util::NUMANodeCount() < 2) {
+    m_ngram.reset(new Model(m_path.c_str(), config));
+    return;
+  }
+
+  // one copy in each node's memory. mmapped files can't be copied, so read
+  if (config.load_method != util::READ && config.load_method != util::PARALLEL_READ) {
+    config.load_method = util::PARALLEL_READ;
+  }
+  for (size_t node = 0; node < util::NUMANodeCount(); ++node) {
+    util::NUMABindScope bind(node);
+    m_replicas.push_back(boost::shared_ptr<Model>(new Model(m_path.c_str(), config)));
+    // same file, same vocab ids
+    config.enumerate_vocab = NULL;
+  }
+  m_ngram = m_replicas[0];
 }
 
 template<class Model>
@@ -159,7 +184,7 @@ void KENLM<Model>::EmptyHypothesisState(FFState &state, const ManagerBase &mgr,
                                         const InputType &input, const Hypothesis &hypo) const
 {
   KenLMState &stateCast = static_cast<KenLMState&>(state);
-  stateCast.state = m_ngram->BeginSentenceState();
+  stateCast.state = GetModel().BeginSentenceState();
 }
 
 template<class Model>
@@ -254,32 +279,33 @@ void KENLM<Model>::EvaluateWhenApplied(const ManagerBase &mgr,
   const std::size_t begin = hypo.GetCurrTargetWordsRange().GetStartPos();
   //[begin, end) in STL-like fashion.
   const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
-  const std::size_t adjust_end = std::min(end, begin + m_ngram->Order() - 1);
+  const Model &model = GetModel();
+  const std::size_t adjust_end = std::min(end, begin + model.Order() - 1);
 
   std::size_t position = begin;
   typename Model::State aux_state;
   typename Model::State *state0 = &stateCast.state, *state1 = &aux_state;
 
-  float score = m_ngram->Score(in_state, TranslateID(hypo.GetWord(position)),
-                               *state0);
+  float score = model.Score(in_state, TranslateID(hypo.GetWord(position)),
+                            *state0);
   ++position;
   for (; position < adjust_end; ++position) {
-    score += m_ngram->Score(*state0, TranslateID(hypo.GetWord(position)),
-                            *state1);
+    score += model.Score(*state0, TranslateID(hypo.GetWord(position)),
+                         *state1);
     std::swap(state0, state1);
   }
 
   if (hypo.GetBitmap().IsComplete()) {
     // Score end of sentence.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
+    std::vector<lm::WordIndex> indices(model.Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    score += m_ngram->FullScoreForgotState(&indices.front(), last,
-                                           m_ngram->GetVocabulary().EndSentence(), stateCast.state).prob;
+    score += model.FullScoreForgotState(&indices.front(), last,
+                                        model.GetVocabulary().EndSentence(), stateCast.state).prob;
   } else if (adjust_end < end) {
     // Get state after adding a long phrase.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
+    std::vector<lm::WordIndex> indices(model.Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    m_ngram->GetState(&indices.front(), last, stateCast.state);
+    model.GetState(&indices.front(), last, stateCast.state);
   } else if (state0 != &stateCast.state) {
     // Short enough phrase that we can just reuse the state.
     stateCast.state = *state0;
@@ -309,7 +335,7 @@ void KENLM<Model>::CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScor
   if (!phrase.GetSize()) return;
 
   lm::ngram::ChartState discarded_sadly;
-  lm::ngram::RuleScore<Model> scorer(*m_ngram, discarded_sadly);
+  lm::ngram::RuleScore<Model> scorer(GetModel(), discarded_sadly);
 
   size_t position;
   if (m_bos == phrase[0][m_factorType]) {
@@ -319,7 +345,7 @@ void KENLM<Model>::CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScor
     position = 0;
   }
 
-  size_t ngramBoundary = m_ngram->Order() - 1;
+  size_t ngramBoundary = GetModel().Order() - 1;
 
   size_t end_loop = std::min(ngramBoundary, phrase.GetSize());
   for (; position < end_loop; ++position) {
@@ -352,7 +378,7 @@ void KENLM<Model>::CalcScore(const Phrase<SCFG::Word> &phrase, float &fullScore,
   if (!phrase.GetSize()) return;
 
   lm::ngram::ChartState discarded_sadly;
-  lm::ngram::RuleScore<Model> scorer(*m_ngram, discarded_sadly);
+  lm::ngram::RuleScore<Model> scorer(GetModel(), discarded_sadly);
 
   size_t position;
   if (m_bos == phrase[0][m_factorType]) {
@@ -362,7 +388,7 @@ void KENLM<Model>::CalcScore(const Phrase<SCFG::Word> &phrase, float &fullScore,
     position = 0;
   }
 
-  size_t ngramBoundary = m_ngram->Order() - 1;
+  size_t ngramBoundary = GetModel().Order() - 1;
 
   size_t end_loop = std::min(ngramBoundary, phrase.GetSize());
   for (; position < end_loop; ++position) {
@@ -400,12 +426,12 @@ lm::WordIndex *KENLM<Model>::LastIDs(const Hypothesis &hypo,
                                      lm::WordIndex *indices) const
 {
   lm::WordIndex *index = indices;
-  lm::WordIndex *end = indices + m_ngram->Order() - 1;
+  lm::WordIndex *end = indices + GetModel().Order() - 1;
   int position = hypo.GetCurrTargetWordsRange().GetEndPos();
   for (;; ++index, --position) {
     if (index == end) return index;
     if (position == -1) {
-      *index = m_ngram->GetVocabulary().BeginSentence();
+      *index = GetModel().GetVocabulary().BeginSentence();
       return index + 1;
     }
     *index = TranslateID(hypo.GetWord(position));
@@ -418,7 +444,7 @@ void KENLM<Model>::EvaluateWhenApplied(const SCFG::Manager &mgr,
                                        FFState &state) const
 {
   LanguageModelChartStateKenLM &newState = static_cast<LanguageModelChartStateKenLM&>(state);
-  lm::ngram::RuleScore<Model> ruleScore(*m_ngram, newState.GetChartState());
+  lm::ngram::RuleScore<Model> ruleScore(GetModel(), newState.GetChartState());
   const SCFG::TargetPhraseImpl &target = hypo.GetTargetPhrase();
   const AlignmentInfo::NonTermIndexMap &nonTermIndexMap =
     target.GetAlignNonTerm().GetNonTermIndexMap();
@@ -482,6 +508,8 @@ template class KENLM<lm::ngram::TrieModel> ;
 template class KENLM<lm::ngram::ArrayTrieModel> ;
 template class KENLM<lm::ngram::QuantTrieModel> ;
 template class KENLM<lm::ngram::QuantArrayTrieModel> ;
+template class KENLM<lm::ngram::EliasFanoTrieModel> ;
+template class KENLM<lm::ngram::QuantEliasFanoTrieModel> ;
 
 FeatureFunction *ConstructKenLM(size_t startInd, const std::string &lineOrig)
 {
@@ -562,6 +590,12 @@ FeatureFunction *ConstructKenLM(size_t startInd, const std::string &line,
     case lm::ngram::QUANT_ARRAY_TRIE:
       return new KENLM<lm::ngram::QuantArrayTrieModel>(startInd, line, file,
              factorType, load_method);
+    case lm::ngram::EF_TRIE:
+      return new KENLM<lm::ngram::EliasFanoTrieModel>(startInd, line, file,
+             factorType, load_method);
+    case lm::ngram::QUANT_EF_TRIE:
+      return new KENLM<lm::ngram::QuantEliasFanoTrieModel>(startInd, line, file,
+             factorType, load_method);
     default:
       UTIL_THROW2("Unrecognized kenlm model type " << model_type)
       ;
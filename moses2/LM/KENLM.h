@@ -8,6 +8,7 @@
 #include <boost/shared_ptr.hpp>
 #include "../FF/StatefulFeatureFunction.h"
 #include "lm/model.hh"
+#include "util/numa.hh"
 #include "../legacy/Factor.h"
 #include "../legacy/Util2.h"
 #include "../Word.h"
@@ -33,6 +34,8 @@ public:
 
   virtual void Load(System &system);
 
+  virtual void SetParameter(const std::string& key, const std::string& value);
+
   virtual FFState* BlankState(MemPool &pool, const System &sys) const;
 
   //! return the state associated with the empty hypothesis for a given sentence
@@ -66,6 +69,19 @@ protected:
 
   boost::shared_ptr<Model> m_ngram;
 
+  // numa-replicas=true loads a copy into each NUMA node's memory. Pin the
+  // decoding threads (cpu-affinity-offset) so each keeps using its own
+  bool m_numaReplicas;
+  std::vector<boost::shared_ptr<Model> > m_replicas;
+
+  // the copy local to the calling thread
+  const Model &GetModel() const {
+    if (m_replicas.empty()) {
+      return *m_ngram;
+    }
+    return *m_replicas[util::CurrentNUMANode() % m_replicas.size()];
+  }
+
   void CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScore, float &ngramScore,
                  std::size_t &oovCount) const;
 
@@ -84,6 +84,8 @@ private:
 /////////////////////////////////////////////////////////////////
 KENLMBatch::KENLMBatch(size_t startInd, const std::string &line)
   :StatefulFeatureFunction(startInd, line)
+  ,m_batchSize(1000)
+  ,m_maxDelay(100)
   ,m_numHypos(0)
 {
   cerr << "KENLMBatch::KENLMBatch" << endl;
@@ -203,13 +205,13 @@ void KENLMBatch::EvaluateWhenApplied(const ManagerBase &mgr,
 
   if (hypo.GetBitmap().IsComplete()) {
     // Score end of sentence.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
+    std::vector<lm::WordIndex> indices(std::max<size_t>(m_ngram->Order() - 1, 1));
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
     score += m_ngram->FullScoreForgotState(&indices.front(), last,
                                            m_ngram->GetVocabulary().EndSentence(), stateCast.state).prob;
   } else if (adjust_end < end) {
     // Get state after adding a long phrase.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
+    std::vector<lm::WordIndex> indices(std::max<size_t>(m_ngram->Order() - 1, 1));
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
     m_ngram->GetState(&indices.front(), last, stateCast.state);
   } else if (state0 != &stateCast.state) {
@@ -303,6 +305,10 @@ void KENLMBatch::SetParameter(const std::string& key,
     m_load_method =
       boost::lexical_cast<bool>(value) ?
       util::LAZY : util::POPULATE_OR_READ;
+  } else if (key == "batch-size") {
+    m_batchSize = Scan<size_t>(value);
+  } else if (key == "max-delay") {
+    m_maxDelay = Scan<size_t>(value);
   } else if (key == "load") {
     if (value == "lazy") {
       m_load_method = util::LAZY;
@@ -325,38 +331,163 @@ void KENLMBatch::SetParameter(const std::string& key,
 }
 
 void KENLMBatch::EvaluateWhenAppliedBatch(
+  const System &system,
   const Batch &batch) const
 {
-  {
-    // write lock
-    boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
-    m_batches.push_back(&batch);
-    m_numHypos += batch.size();
+  BatchRequest request(batch);
+
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  m_batches.push_back(&request);
+  m_numHypos += batch.size();
+
+  boost::system_time deadline = boost::get_system_time()
+                                + boost::posix_time::microseconds(m_maxDelay);
+
+  while (!request.done) {
+    if (!request.taken
+        && (m_numHypos >= m_batchSize || boost::get_system_time() >= deadline)) {
+      // flush everything that's queued, including batches from other threads
+      std::vector<BatchRequest*> batches;
+      batches.swap(m_batches);
+      m_numHypos = 0;
+      BOOST_FOREACH(BatchRequest *other, batches) {
+        other->taken = true;
+      }
+
+      // the waiting threads throw whatever this one hit, rather than waiting
+      // for ever
+      std::string error;
+      lock.unlock();
+      try {
+        EvaluateWhenAppliedBatch(batches);
+      } catch (const std::exception &e) {
+        error = std::string("Batched LM scoring failed: ") + e.what();
+      }
+      lock.lock();
+
+      BOOST_FOREACH(BatchRequest *other, batches) {
+        other->error = error;
+        other->done = true;
+      }
+      m_threadNeeded.notify_all();
+    } else if (request.taken) {
+      // another thread is scoring our batch
+      m_threadNeeded.wait(lock);
+    } else {
+      m_threadNeeded.timed_wait(lock, deadline);
+    }
   }
-  //cerr << "m_numHypos=" << m_numHypos << endl;
 
-  if (m_numHypos > 0) {
-    // process batch
-    EvaluateWhenAppliedBatch();
+  UTIL_THROW_IF2(!request.error.empty(), request.error);
+}
 
-    m_batches.clear();
-    m_numHypos = 0;
+void KENLMBatch::EvaluateWhenAppliedBatch(
+  const std::vector<BatchRequest*> &batches) const
+{
+  // 1 cursor per hypo. Words are scored one position at a time across all
+  // hypos with FullScoreBatch(), which prefetches the hash table buckets of
+  // the independent queries so their cache misses overlap
+  struct Cursor {
+    Hypothesis *hypo;
+    const Model::State *state0;
+    Model::State *state1;
+    Model::State aux;
+    size_t position, scoreEnd, adjustEnd, end;
+    float score;
+  };
+
+  size_t numHypos = 0;
+  BOOST_FOREACH(const BatchRequest *request, batches) {
+    numHypos += request->batch->size();
+  }
 
-    m_threadNeeded.notify_all();
-  } else {
-    boost::mutex::scoped_lock lock(m_mutex);
-    m_threadNeeded.wait(lock);
+  // reserve so the state pointers into aux stay valid
+  std::vector<Cursor> cursors;
+  cursors.reserve(numHypos);
+
+  size_t statefulInd = GetStatefulInd();
+  BOOST_FOREACH(const BatchRequest *request, batches) {
+    BOOST_FOREACH(Hypothesis *hypo, *request->batch) {
+      const lm::ngram::State &in_state =
+        static_cast<const KenLMState*>(hypo->GetPrevHypo()->GetState(statefulInd))->state;
+      KenLMState &stateCast = *static_cast<KenLMState*>(hypo->GetState(statefulInd));
+
+      if (!hypo->GetTargetPhrase().GetSize()) {
+        stateCast.state = in_state;
+        continue;
+      }
+
+      cursors.resize(cursors.size() + 1);
+      Cursor &cursor = cursors.back();
+      cursor.hypo = hypo;
+      cursor.position = hypo->GetCurrTargetWordsRange().GetStartPos();
+      cursor.end = hypo->GetCurrTargetWordsRange().GetEndPos() + 1;
+      cursor.adjustEnd = std::min(cursor.end, cursor.position + m_ngram->Order() - 1);
+      // like EvaluateWhenApplied, the first word is scored even for a unigram
+      // model
+      cursor.scoreEnd = std::max(cursor.adjustEnd, cursor.position + 1);
+      cursor.state0 = &in_state;
+      cursor.state1 = &stateCast.state;
+      cursor.score = 0;
+    }
   }
-}
 
-void KENLMBatch::EvaluateWhenAppliedBatch() const
-{
-  BOOST_FOREACH(const Batch *batch, m_batches) {
-    //cerr << "batch=" << batch->size() << endl;
-    BOOST_FOREACH(Hypothesis *hypo, *batch) {
-      hypo->EvaluateWhenApplied(*this);
+  // interleaved sweep. state0 is the last state written, state1 the next
+  std::vector<const Model::State*> inStates(cursors.size());
+  std::vector<Model::State*> outStates(cursors.size());
+  std::vector<lm::WordIndex> words(cursors.size());
+  std::vector<lm::FullScoreReturn> rets(cursors.size());
+  std::vector<Cursor*> active(cursors.size());
+  while (true) {
+    size_t count = 0;
+    BOOST_FOREACH(Cursor &cursor, cursors) {
+      if (cursor.position < cursor.scoreEnd) {
+        inStates[count] = cursor.state0;
+        outStates[count] = cursor.state1;
+        words[count] = TranslateID(cursor.hypo->GetWord(cursor.position));
+        active[count++] = &cursor;
+      }
+    }
+    if (count == 0) {
+      break;
+    }
+
+    m_ngram->FullScoreBatch(&inStates.front(), &words.front(), &outStates.front(),
+                            &rets.front(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+      Cursor &cursor = *active[i];
+      cursor.score += rets[i].prob;
+      KenLMState &stateCast = *static_cast<KenLMState*>(cursor.hypo->GetState(statefulInd));
+      cursor.state1 = (cursor.state1 == &stateCast.state) ? &cursor.aux : &stateCast.state;
+      cursor.state0 = outStates[i];
+      ++cursor.position;
     }
   }
+
+  // at least 1 so front() is valid for a unigram model, which has no context
+  std::vector<lm::WordIndex> indices(std::max<size_t>(m_ngram->Order() - 1, 1));
+  BOOST_FOREACH(Cursor &cursor, cursors) {
+    Hypothesis &hypo = *cursor.hypo;
+    KenLMState &stateCast = *static_cast<KenLMState*>(hypo.GetState(statefulInd));
+
+    if (hypo.GetBitmap().IsComplete()) {
+      // Score end of sentence.
+      const lm::WordIndex *last = LastIDs(hypo, &indices.front());
+      cursor.score += m_ngram->FullScoreForgotState(&indices.front(), last,
+                      m_ngram->GetVocabulary().EndSentence(), stateCast.state).prob;
+    } else if (cursor.adjustEnd < cursor.end) {
+      // Get state after adding a long phrase.
+      const lm::WordIndex *last = LastIDs(hypo, &indices.front());
+      m_ngram->GetState(&indices.front(), last, stateCast.state);
+    } else if (cursor.state0 != &stateCast.state) {
+      // Short enough phrase that we can just reuse the state.
+      stateCast.state = *cursor.state0;
+    }
+
+    float score = TransformLMScore(cursor.score);
+    hypo.GetScores().PlusEquals(hypo.GetManager().system, *this, score);
+  }
 }
 
 void KENLMBatch::EvaluateWhenApplied(const SCFG::Manager &mgr,
@@ -62,6 +62,7 @@ public:
                                    FFState &state) const;
 
   virtual void EvaluateWhenAppliedBatch(
+    const System &system,
     const Batch &batch) const;
 
 protected:
@@ -86,16 +87,30 @@ protected:
 
   std::vector<lm::WordIndex> m_lmIdLookup;
 
-  // batch
-  mutable std::vector<const Batch*> m_batches;
-  mutable size_t m_numHypos;
+  // batch. Batches from all decoding threads are queued here until there are
+  // m_batchSize hypos, or the oldest has waited m_maxDelay microseconds.
+  // Whichever thread triggers the flush scores everything that is queued.
+  struct BatchRequest {
+    const Batch *batch;
+    bool taken, done;
+    // set if scoring threw
+    std::string error;
+
+    BatchRequest(const Batch &b)
+      :batch(&b), taken(false), done(false) {
+    }
+  };
 
-  mutable boost::shared_mutex m_accessLock;
+  size_t m_batchSize;
+  size_t m_maxDelay;
+
+  mutable std::vector<BatchRequest*> m_batches;
+  mutable size_t m_numHypos;
 
   mutable boost::mutex m_mutex;
   mutable boost::condition_variable m_threadNeeded;
 
-  void EvaluateWhenAppliedBatch() const;
+  void EvaluateWhenAppliedBatch(const std::vector<BatchRequest*> &batches) const;
 
 };
 
@@ -69,6 +69,11 @@ public:
                                    const SCFG::Hypothesis &hypo, int featureID, Scores &scores,
                                    FFState &state) const;
 
+  // LMState context is allocated from the manager pool
+  virtual bool AllocatesFromManagerPool() const {
+    return true;
+  }
+
 protected:
   std::string m_path;
   FactorType m_factorType;
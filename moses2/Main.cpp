@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <vector>
 #include <boost/pool/pool_alloc.hpp>
 #include "Main.h"
 #include "System.h"
@@ -51,6 +53,11 @@ int main(int argc, char** argv)
   }
 
   cerr << "Decoding took " << timer.get_elapsed_time() << endl;
+  int verbose;
+  params.SetParameter(verbose, "verbose", 1);
+  if (verbose >= 2) {
+    Moses2::MemPool::Debug(cerr);
+  }
   //	cerr << "g_numHypos=" << g_numHypos << endl;
   cerr << "Finished" << endl;
   return EXIT_SUCCESS;
@@ -76,20 +83,68 @@ istream &GetInputStream(Moses2::Parameter &params)
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+
+size_t CountWords(const string &line)
+{
+  size_t ret = 0;
+  bool inWord = false;
+  for (size_t i = 0; i < line.size(); ++i) {
+    bool space = (line[i] == ' ' || line[i] == '\t');
+    if (!space && !inWord) {
+      ++ret;
+    }
+    inWord = !space;
+  }
+  return ret;
+}
+
+// longest first. Ties in input order
+bool LongerSentence(const pair<size_t, long> &a, const pair<size_t, long> &b)
+{
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+}
+
 void batch_run(Moses2::Parameter &params, Moses2::System &system, Moses2::ThreadPool &pool)
 {
   istream &inStream = GetInputStream(params);
 
+  bool longestFirst;
+  params.SetParameter(longestFirst, "longest-first", false);
+
   long translationId = 0;
   string line;
-  while (getline(inStream, line)) {
-    //cerr << "line=" << line << endl;
-    boost::shared_ptr<Moses2::TranslationTask> task(new Moses2::TranslationTask(system, line, translationId));
-
-    //cerr << "START pool.Submit()" << endl;
-    pool.Submit(task);
-    //task->Run();
-    ++translationId;
+  if (longestFirst) {
+    // long sentences at the end of the input would otherwise leave most
+    // threads idle while one thread finishes them.
+    // The output collector still writes in input order
+    vector<string> lines;
+    vector<pair<size_t, long> > order;
+    while (getline(inStream, line)) {
+      order.push_back(pair<size_t, long>(CountWords(line), translationId));
+      lines.push_back(line);
+      ++translationId;
+    }
+    std::sort(order.begin(), order.end(), LongerSentence);
+
+    for (size_t i = 0; i < order.size(); ++i) {
+      long id = order[i].second;
+      boost::shared_ptr<Moses2::TranslationTask> task(new Moses2::TranslationTask(system, lines[id], id));
+      pool.Submit(task);
+    }
+  } else {
+    while (getline(inStream, line)) {
+      //cerr << "line=" << line << endl;
+      boost::shared_ptr<Moses2::TranslationTask> task(new Moses2::TranslationTask(system, line, translationId));
+
+      //cerr << "START pool.Submit()" << endl;
+      pool.Submit(task);
+      //task->Run();
+      ++translationId;
+    }
   }
 
   pool.Stop(true);
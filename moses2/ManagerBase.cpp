@@ -29,6 +29,9 @@ ManagerBase::ManagerBase(System &sys, const TranslationTask &task,
   ,m_pool(NULL)
   ,m_systemPool(NULL)
   ,m_hypoRecycle(NULL)
+  ,m_timeBudget(sys.options.cube.time_budget / 1000.0)
+  ,m_timeLimit(0)
+  ,m_degradation(0)
 {
 }
 
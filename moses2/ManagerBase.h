@@ -17,6 +17,7 @@
 #include "EstimatedScores.h"
 #include "ArcLists.h"
 #include "legacy/Bitmaps.h"
+#include "legacy/Timer.h"
 
 namespace Moses2
 {
@@ -65,11 +66,47 @@ public:
     return m_translationId;
   }
 
+  // cube pruning's budget: seconds this sentence may take to decode.
+  // 0 = no limit
+  double GetTimeBudget() const {
+    return m_timeBudget;
+  }
+  void SetTimeBudget(double seconds) {
+    m_timeBudget = seconds;
+  }
+
+  // seconds left before the server's request times out, for any search
+  // algorithm. 0 = no limit. Only the server sets it
+  double GetTimeLimit() const {
+    return m_timeLimit;
+  }
+  void SetTimeLimit(double seconds) {
+    m_timeLimit = seconds;
+  }
+
+  // seconds since Decode() started
+  double GetElapsedTime() const {
+    return m_timer.get_elapsed_time();
+  }
+
+  // fraction of the search given up to stay within the time budget. 0 = full search
+  float GetDegradation() const {
+    return m_degradation;
+  }
+  void SetDegradation(float degradation) {
+    m_degradation = degradation;
+  }
+
 protected:
   std::string m_inputStr;
   long m_translationId;
   InputType *m_input;
 
+  Timer m_timer;
+  double m_timeBudget;
+  double m_timeLimit;
+  float m_degradation;
+
   mutable MemPool *m_pool, *m_systemPool;
   mutable Recycler<HypothesisBase*> *m_hypoRecycle;
 
@@ -6,6 +6,9 @@
  */
 
 #include <boost/foreach.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include "MemPool.h"
 #include "util/scoped.hh"
 #include "legacy/Util2.h"
@@ -26,11 +29,130 @@ MemPool::Page::~Page()
 {
   free(mem);
 }
+////////////////////////////////////////////////////
+namespace
+{
+// set once at start-up, before any decoding thread runs
+size_t s_poolBudget = 0, s_freeListBudget = 0;
+
+// all pools
+boost::atomic<size_t> s_poolSize(0), s_peakPoolSize(0), s_numResets(0);
+
+void AddPoolSize(size_t size)
+{
+  size_t poolSize = (s_poolSize += size);
+  size_t peak = s_peakPoolSize.load();
+  while (poolSize > peak && !s_peakPoolSize.compare_exchange_weak(peak, poolSize)) {
+  }
+}
+}
+
+// released pages of all threads, for any pool to re-use. Only touched when
+// a pool releases or needs a whole page, never by Allocate()
+struct MemPool::FreeList {
+  boost::mutex mutex;
+  std::vector<Page*> pages;
+  size_t size;
+
+  FreeList()
+    :size(0) {
+  }
+  ~FreeList() {
+    BOOST_FOREACH(Page *page, pages) {
+      delete page;
+    }
+  }
+};
+
+MemPool::FreeList &MemPool::GetFreeList()
+{
+  static FreeList freeList;
+  return freeList;
+}
+
+void MemPool::SetBudget(size_t poolBudget, size_t freeListBudget)
+{
+  s_poolBudget = poolBudget;
+  s_freeListBudget = freeListBudget;
+}
+
+void MemPool::Debug(std::ostream &out)
+{
+  out << "MemPool: current=" << s_poolSize.load()
+      << " peak=" << s_peakPoolSize.load()
+      << " resets=" << s_numResets.load();
+  if (s_freeListBudget) {
+    FreeList &freeList = GetFreeList();
+    boost::lock_guard<boost::mutex> lock(freeList.mutex);
+    out << " free-list=" << freeList.size;
+  }
+  out << endl;
+}
+
+MemPool::Page *MemPool::NewPage(std::size_t size)
+{
+  Page *page = NULL;
+  if (s_freeListBudget) {
+    FreeList &freeList = GetFreeList();
+    boost::lock_guard<boost::mutex> lock(freeList.mutex);
+
+    // smallest free page that is big enough
+    size_t best = freeList.pages.size();
+    for (size_t i = 0; i < freeList.pages.size(); ++i) {
+      size_t pageSize = freeList.pages[i]->size;
+      if (pageSize >= size
+          && (best == freeList.pages.size() || pageSize < freeList.pages[best]->size)) {
+        best = i;
+      }
+    }
+    if (best < freeList.pages.size()) {
+      page = freeList.pages[best];
+      freeList.pages[best] = freeList.pages.back();
+      freeList.pages.pop_back();
+      freeList.size -= page->size;
+    }
+  }
+
+  if (page == NULL) {
+    page = new Page(size);
+  }
+  AddPoolSize(page->size);
+  return page;
+}
+
+void MemPool::ReleasePage(Page *page)
+{
+  s_poolSize -= page->size;
+  if (s_freeListBudget == 0 || page->size > s_freeListBudget) {
+    delete page;
+    return;
+  }
+
+  // keep the newest page. Trim the largest others to stay within budget
+  FreeList &freeList = GetFreeList();
+  boost::lock_guard<boost::mutex> lock(freeList.mutex);
+  freeList.pages.push_back(page);
+  freeList.size += page->size;
+  while (freeList.size > s_freeListBudget) {
+    size_t largest = 0;
+    for (size_t i = 1; i + 1 < freeList.pages.size(); ++i) {
+      if (freeList.pages[i]->size > freeList.pages[largest]->size) {
+        largest = i;
+      }
+    }
+    Page *trimmed = freeList.pages[largest];
+    freeList.pages[largest] = freeList.pages.back();
+    freeList.pages.pop_back();
+    freeList.size -= trimmed->size;
+    delete trimmed;
+  }
+}
+
 ////////////////////////////////////////////////////
 MemPool::MemPool(size_t initSize) :
   m_currSize(initSize), m_currPage(0)
 {
-  Page *page = new Page(m_currSize);
+  Page *page = NewPage(m_currSize);
   m_pages.push_back(page);
 
   current_ = page->mem;
@@ -40,7 +162,9 @@ MemPool::MemPool(size_t initSize) :
 MemPool::~MemPool()
 {
   //cerr << "delete memory pool" << endl;
-  RemoveAllInColl(m_pages);
+  BOOST_FOREACH(Page *page, m_pages) {
+    ReleasePage(page);
+  }
 }
 
 uint8_t *MemPool::More(std::size_t size)
@@ -51,7 +175,7 @@ uint8_t *MemPool::More(std::size_t size)
     m_currSize <<= 1;
     std::size_t amount = std::max(m_currSize, size);
 
-    Page *page = new Page(amount);
+    Page *page = NewPage(amount);
     m_pages.push_back(page);
 
     uint8_t *ret = page->mem;
@@ -73,9 +197,26 @@ uint8_t *MemPool::More(std::size_t size)
 
 void MemPool::Reset()
 {
+  ++s_numResets;
+
+  if (s_poolBudget) {
+    // keep the 1st page and as many of the following as fit in the budget
+    size_t kept = m_pages[0]->size;
+    size_t numKept = 1;
+    while (numKept < m_pages.size() && kept + m_pages[numKept]->size <= s_poolBudget) {
+      kept += m_pages[numKept]->size;
+      ++numKept;
+    }
+
+    for (size_t i = numKept; i < m_pages.size(); ++i) {
+      ReleasePage(m_pages[i]);
+    }
+    m_pages.resize(numKept);
+    m_currSize = std::min(m_currSize, m_pages.back()->size);
+  }
+
   m_currPage = 0;
   current_ = m_pages[0]->mem;
 }
 
 }
-
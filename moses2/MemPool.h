@@ -64,10 +64,27 @@ public:
     return (T*) ret;
   }
 
-  // re-use pool
+  // re-use pool. Pages beyond the budget go to the shared free list
   void Reset();
 
+  // Bytes of pages each pool keeps after Reset(), and bytes of released pages
+  // kept on a free list shared by all threads. The largest are freed first
+  // when the free list goes over. 0 = keep everything in the pool, free
+  // released pages straight away. This is the default.
+  // Call before decoding starts
+  static void SetBudget(size_t poolBudget, size_t freeListBudget);
+
+  // process-wide statistics and size of the free list
+  static void Debug(std::ostream &out);
+
 private:
+  struct FreeList;
+  static FreeList &GetFreeList();
+
+  // from the free list if possible
+  static Page *NewPage(std::size_t size);
+  static void ReleasePage(Page *page);
+
   uint8_t *More(std::size_t size);
 
   std::vector<Page*> m_pages;
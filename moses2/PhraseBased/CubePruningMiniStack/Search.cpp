@@ -40,6 +40,9 @@ Search::Search(Manager &mgr) :
 
   , m_queueItemRecycler(MemPoolAllocator<QueueItem*>(mgr.GetPool()))
 
+  , m_searchStart(0)
+  , m_numPops(0)
+  , m_numPopsDropped(0)
 {
 }
 
@@ -50,6 +53,7 @@ Search::~Search()
 void Search::Decode()
 {
   const Sentence &sentence = static_cast<const Sentence&>(mgr.GetInput());
+  m_searchStart = mgr.GetElapsedTime();
 
   // init cue edges
   m_cubeEdges.resize(sentence.GetSize() + 1);
@@ -78,6 +82,38 @@ void Search::Decode()
     //m_stack.DebugCounts();
   }
 
+  if (m_numPopsDropped) {
+    size_t popLimit = mgr.system.options.cube.pop_limit;
+    mgr.SetDegradation((float) m_numPopsDropped / (popLimit * m_cubeEdges.size()));
+  }
+}
+
+size_t Search::GetPopLimit(size_t stackInd) const
+{
+  size_t popLimit = mgr.system.options.cube.pop_limit;
+  double budget = mgr.GetTimeBudget();
+  double limit = mgr.GetTimeLimit();
+  if (limit > 0 && (budget <= 0 || limit < budget)) {
+    budget = limit;
+  }
+  if (budget <= 0 || m_numPops == 0) {
+    return popLimit;
+  }
+
+  // share the time left between the remaining stacks, at the speed of the
+  // stacks decoded so far
+  double elapsed = mgr.GetElapsedTime();
+  double timePerPop = (elapsed - m_searchStart) / m_numPops;
+  size_t numStacks = m_cubeEdges.size() - stackInd;
+  double timePerStack = (budget - elapsed) / numStacks;
+
+  size_t affordable = 0;
+  if (timePerStack > 0) {
+    affordable = (timePerPop * popLimit > timePerStack) ? timePerStack / timePerPop : popLimit;
+  }
+
+  size_t minPopLimit = mgr.system.options.cube.min_pop_limit;
+  return std::min(popLimit, std::max(minPopLimit, affordable));
 }
 
 void Search::Decode(size_t stackInd)
@@ -119,8 +155,10 @@ void Search::Decode(size_t stackInd)
   cerr << endl;
    */
 
+  size_t popLimit = GetPopLimit(stackInd);
+
   size_t pops = 0;
-  while (!m_queue.empty() && pops < mgr.system.options.cube.pop_limit) {
+  while (!m_queue.empty() && pops < popLimit) {
     // get best hypo from queue, add to stack
     //cerr << "queue=" << queue.size() << endl;
     QueueItem *item = m_queue.top();
@@ -142,6 +180,15 @@ void Search::Decode(size_t stackInd)
 
     ++pops;
   }
+  m_numPops += pops;
+
+  // pops given up because of the time budget: the items still queued, up to
+  // the fixed pop limit. Each stack starts with an empty queue, so no pop is
+  // counted twice. Items those pops would have queued in turn aren't counted
+  size_t fullPopLimit = mgr.system.options.cube.pop_limit;
+  if (pops == popLimit && popLimit < fullPopLimit) {
+    m_numPopsDropped += std::min(m_queue.size(), fullPopLimit - pops);
+  }
 
   // create hypo from every edge. Increase diversity
   if (mgr.system.options.cube.diversity) {
@@ -50,10 +50,17 @@ protected:
 
   QueueItemRecycler m_queueItemRecycler;
 
+  // time budget
+  double m_searchStart; // elapsed time when search started
+  size_t m_numPops, m_numPopsDropped;
+
   // CUBE PRUNING
   // decoding
   void Decode(size_t stackInd);
   void PostDecode(size_t stackInd);
+
+  // pop limit for the stack, reduced so the remaining stacks fit in the time budget
+  size_t GetPopLimit(size_t stackInd) const;
 };
 
 }
@@ -38,6 +38,11 @@ Hypothesis *Hypothesis::Create(MemPool &pool, Manager &mgr)
   return ret;
 }
 
+Hypothesis *Hypothesis::Create(MemPool &pool, const System &system)
+{
+  return new (pool.Allocate<Hypothesis>()) Hypothesis(pool, system);
+}
+
 Hypothesis::Hypothesis(MemPool &pool, const System &system) :
   HypothesisBase(pool, system), m_currTargetWordsRange()
 {
@@ -106,6 +111,11 @@ bool Hypothesis::operator==(const Hypothesis &other) const
   return ret;
 }
 
+bool Hypothesis::operator==(const HypothesisBase &other) const
+{
+  return *this == static_cast<const Hypothesis&>(other);
+}
+
 std::string Hypothesis::Debug(const System &system) const
 {
   stringstream out;
@@ -31,6 +31,9 @@ class Hypothesis: public HypothesisBase
 public:
 
   static Hypothesis *Create(MemPool &pool, Manager &mgr);
+
+  // not kept by the manager's recycler. For threads other than the manager's
+  static Hypothesis *Create(MemPool &pool, const System &system);
   virtual ~Hypothesis();
 
   // initial, empty hypo
@@ -42,6 +45,7 @@ public:
 
   size_t hash() const;
   bool operator==(const Hypothesis &other) const;
+  virtual bool operator==(const HypothesisBase &other) const;
 
   inline const Bitmap &GetBitmap() const {
     return *m_sourceCompleted;
@@ -91,11 +91,8 @@ void Manager::Init()
 
   switch (system.options.search.algo) {
   case Normal:
-    m_search = new NSNormal::Search(*this);
-    break;
   case NormalBatch:
-    //m_search = new NSBatch::Search(*this);
-    UTIL_THROW2("Not implemented");
+    m_search = new NSNormal::Search(*this);
     break;
   case CubePruning:
   case CubePruningMiniStack:
@@ -123,6 +120,7 @@ void Manager::Init()
 void Manager::Decode()
 {
   //cerr << "Start Decode " << this << endl;
+  m_timer.start();
 
   Init();
   m_search->Decode();
@@ -8,6 +8,7 @@
 #include "Search.h"
 #include <algorithm>
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
 #include "Stack.h"
 #include "../Manager.h"
 #include "../TrellisPath.h"
@@ -17,6 +18,7 @@
 #include "../../Phrase.h"
 #include "../../System.h"
 #include "../../PhraseBased/TargetPhrases.h"
+#include "../../FF/StatefulFeatureFunction.h"
 
 using namespace std;
 
@@ -25,17 +27,108 @@ namespace Moses2
 namespace NSNormal
 {
 
+class SearchThreads::Job : public Task
+{
+public:
+  Job(SearchThreads &threads, const boost::function<void()> &func)
+    :m_threads(threads)
+    ,m_func(func) {
+  }
+
+  virtual void Run() {
+    m_func();
+    m_threads.Done();
+  }
+
+protected:
+  SearchThreads &m_threads;
+  boost::function<void()> m_func;
+};
+
+SearchThreads::SearchThreads(size_t numHelpers)
+  :m_threads(numHelpers)
+  ,m_pending(0)
+{
+  for (size_t i = 0; i < numHelpers; ++i) {
+    m_pools.push_back(new MemPool());
+  }
+}
+
+SearchThreads::~SearchThreads()
+{
+  m_threads.Stop();
+  RemoveAllInColl(m_pools);
+}
+
+void SearchThreads::Reset()
+{
+  BOOST_FOREACH(MemPool *pool, m_pools) {
+    pool->Reset();
+  }
+}
+
+void SearchThreads::Submit(const boost::function<void()> &func)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    ++m_pending;
+  }
+  m_threads.Submit(boost::shared_ptr<Task>(new Job(*this, func)));
+}
+
+void SearchThreads::Wait()
+{
+  boost::unique_lock<boost::mutex> lock(m_lock);
+  while (m_pending) {
+    m_cond.wait(lock);
+  }
+}
+
+void SearchThreads::Done()
+{
+  boost::lock_guard<boost::mutex> lock(m_lock);
+  if (--m_pending == 0) {
+    m_cond.notify_all();
+  }
+}
+
+////////////////////////////////////////////////////
 Search::Search(Manager &mgr)
   :Moses2::Search(mgr)
   , m_stacks(mgr)
+  , m_batch(NULL)
+  , m_overBudget(false)
+  , m_numHypos(0)
+  , m_numHyposDropped(0)
+  , m_threads(NULL)
 {
-  // TODO Auto-generated constructor stub
+  if (mgr.system.options.search.algo == NormalBatch) {
+    m_batch = &mgr.system.GetBatch(mgr.GetSystemPool());
+    m_batch->clear();
+  }
 
+  size_t numThreads = mgr.system.options.search.search_threads;
+  if (numThreads > 1 && m_batch == NULL) {
+    const std::vector<const StatefulFeatureFunction*> &sfffs =
+      mgr.system.featureFunctions.GetStatefulFeatureFunctions();
+    BOOST_FOREACH(const StatefulFeatureFunction *sfff, sfffs) {
+      if (sfff->AllocatesFromManagerPool()) {
+        cerr << "WARNING: " << sfff->GetName()
+             << " can't be used with search-threads. Extending stacks in 1 thread" << endl;
+        numThreads = 1;
+        break;
+      }
+    }
+
+    if (numThreads > 1) {
+      m_threads = &mgr.system.GetSearchThreads(numThreads - 1);
+      m_staging.resize(numThreads);
+    }
+  }
 }
 
 Search::~Search()
 {
-  // TODO Auto-generated destructor stub
 }
 
 void Search::Decode()
@@ -43,6 +136,9 @@ void Search::Decode()
   // init stacks
   const Sentence &sentence = static_cast<const Sentence&>(mgr.GetInput());
   m_stacks.Init(mgr, sentence.GetSize() + 1);
+  if (m_threads) {
+    m_threads->Reset();
+  }
 
   const Bitmap &initBitmap = mgr.GetBitmaps().GetInitialBitmap();
   Hypothesis *initHypo = Hypothesis::Create(mgr.GetSystemPool(), mgr);
@@ -52,7 +148,13 @@ void Search::Decode()
 
   m_stacks.Add(initHypo, mgr.GetHypoRecycle(), mgr.arcLists);
 
+  // only the server's request time-out. cube-pruning-time-budget is for
+  // cube pruning
+  double budget = mgr.GetTimeLimit();
   for (size_t stackInd = 0; stackInd < m_stacks.GetSize(); ++stackInd) {
+    if (budget > 0 && !m_overBudget && mgr.GetElapsedTime() >= budget) {
+      m_overBudget = true;
+    }
     Decode(stackInd);
     //cerr << m_stacks << endl;
 
@@ -62,6 +164,10 @@ void Search::Decode()
     }
     //cerr << m_stacks.Debug(mgr.system) << endl;
   }
+
+  if (m_numHyposDropped) {
+    mgr.SetDegradation((float) m_numHyposDropped / m_numHypos);
+  }
 }
 
 void Search::Decode(size_t stackInd)
@@ -73,8 +179,25 @@ void Search::Decode(size_t stackInd)
     return;
   }
 
-  const Hypotheses &hypos = stack.GetSortedAndPrunedHypos(mgr, mgr.arcLists);
-  //cerr << "hypos=" << hypos.size() << endl;
+  const Hypotheses *sorted = &stack.GetSortedAndPrunedHypos(mgr, mgr.arcLists);
+  //cerr << "hypos=" << sorted->size() << endl;
+
+  // out of time: the remaining stacks are only extended from their best
+  // hypothesis, so that the search still gets to the last stack quickly
+  m_numHypos += sorted->size();
+  if (m_overBudget && sorted->size() > 1) {
+    m_numHyposDropped += sorted->size() - 1;
+    MemPool &pool = mgr.GetPool();
+    Hypotheses *best = new (pool.Allocate<Hypotheses>()) Hypotheses(pool, 1);
+    (*best)[0] = (*sorted)[0];
+    sorted = best;
+  }
+  const Hypotheses &hypos = *sorted;
+
+  if (m_threads) {
+    DecodeParallel(hypos);
+    return;
+  }
 
   const InputPaths &paths = mgr.GetInputPaths();
 
@@ -83,6 +206,105 @@ void Search::Decode(size_t stackInd)
       Extend(*static_cast<const Hypothesis*>(hypo), *static_cast<const InputPath*>(path));
     }
   }
+
+  if (m_batch) {
+    mgr.system.featureFunctions.EvaluateWhenAppliedBatch(*m_batch);
+
+    BOOST_FOREACH(Hypothesis *newHypo, *m_batch) {
+      m_stacks.Add(newHypo, mgr.GetHypoRecycle(), mgr.arcLists);
+    }
+    m_batch->clear();
+  }
+}
+
+void Search::DecodeParallel(const Hypotheses &hypos)
+{
+  const InputPaths &paths = mgr.GetInputPaths();
+  const ReorderingConstraint &reorderingConstraint = mgr.GetInput().GetReorderingConstraint();
+  size_t numPt = mgr.system.mappings.size();
+
+  // list the extensions in the order the single-threaded search does them.
+  // Bitmaps isn't thread-safe so new bitmaps are created here too
+  m_extensions.clear();
+  size_t numTps = 0;
+  BOOST_FOREACH(const InputPathBase *pathBase, paths) {
+    const InputPath &path = *static_cast<const InputPath*>(pathBase);
+    const Range &pathRange = path.range;
+
+    BOOST_FOREACH(const HypothesisBase *hypoBase, hypos) {
+      const Hypothesis &hypo = *static_cast<const Hypothesis*>(hypoBase);
+      const Bitmap &hypoBitmap = hypo.GetBitmap();
+      const Range &hypoRange = hypo.GetInputPath().range;
+
+      if (!CanExtend(hypoBitmap, hypoRange.GetEndPos(), pathRange)) {
+        continue;
+      }
+      if (!reorderingConstraint.Check(hypoBitmap, pathRange.GetStartPos(), pathRange.GetEndPos())) {
+        continue;
+      }
+
+      Extension extension;
+      extension.hypo = &hypo;
+      extension.path = &path;
+      extension.newBitmap = &mgr.GetBitmaps().GetBitmap(hypoBitmap, pathRange);
+      extension.estimatedScore = mgr.GetEstimatedScores().CalcEstimatedScore(*extension.newBitmap);
+
+      for (size_t i = 0; i < numPt; ++i) {
+        const TargetPhrases *tps = path.targetPhrases[i];
+        if (tps) {
+          extension.tps = tps;
+          m_extensions.push_back(extension);
+          numTps += tps->GetSize();
+        }
+      }
+    }
+  }
+
+  // contiguous ranges with about the same number of target phrases
+  size_t numThreads = m_staging.size();
+  std::vector<size_t> ends(numThreads);
+  size_t end = 0, done = 0;
+  for (size_t threadInd = 0; threadInd < numThreads; ++threadInd) {
+    size_t goal = numTps * (threadInd + 1) / numThreads;
+    while (end < m_extensions.size() && done < goal) {
+      done += m_extensions[end++].tps->GetSize();
+    }
+    ends[threadInd] = end;
+  }
+
+  // this thread does the 1st range
+  for (size_t threadInd = 1; threadInd < numThreads; ++threadInd) {
+    m_threads->Submit(boost::bind(&Search::ExtendRange, this, threadInd,
+                                  ends[threadInd - 1], ends[threadInd]));
+  }
+  ExtendRange(0, 0, ends[0]);
+  m_threads->Wait();
+
+  BOOST_FOREACH(const std::vector<Hypothesis*> &staging, m_staging) {
+    BOOST_FOREACH(Hypothesis *newHypo, staging) {
+      m_stacks.Add(newHypo, mgr.GetHypoRecycle(), mgr.arcLists);
+    }
+  }
+}
+
+void Search::ExtendRange(size_t threadInd, size_t begin, size_t end)
+{
+  std::vector<Hypothesis*> &staging = m_staging[threadInd];
+  staging.clear();
+
+  for (size_t i = begin; i < end; ++i) {
+    const Extension &extension = m_extensions[i];
+    BOOST_FOREACH(const TargetPhraseImpl *tp, *extension.tps) {
+      // only the manager's thread may use its pool and recycler
+      Hypothesis *newHypo = threadInd
+                            ? Hypothesis::Create(m_threads->GetPool(threadInd - 1), mgr.system)
+                            : Hypothesis::Create(mgr.GetSystemPool(), mgr);
+      newHypo->Init(mgr, *extension.hypo, *extension.path, *tp,
+                    *extension.newBitmap, extension.estimatedScore);
+      newHypo->EvaluateWhenApplied();
+      staging.push_back(newHypo);
+    }
+  }
 }
 
 void Search::Extend(const Hypothesis &hypo, const InputPath &path)
@@ -128,6 +350,12 @@ void Search::Extend(const Hypothesis &hypo, const TargetPhraseImpl &tp,
 {
   Hypothesis *newHypo = Hypothesis::Create(mgr.GetSystemPool(), mgr);
   newHypo->Init(mgr, hypo, path, tp, newBitmap, estimatedScore);
+
+  if (m_batch) {
+    m_batch->push_back(newHypo);
+    return;
+  }
+
   newHypo->EvaluateWhenApplied();
 
   m_stacks.Add(newHypo, mgr.GetHypoRecycle(), mgr.arcLists);
@@ -7,6 +7,11 @@
 #pragma once
 
 #include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include "../../MemPool.h"
+#include "../../legacy/ThreadPool.h"
 #include "../../legacy/Range.h"
 #include "../../legacy/Bitmap.h"
 #include "../../TypeDef.h"
@@ -24,6 +29,44 @@ namespace NSNormal
 {
 class Stacks;
 
+// The helper threads of search-threads > 1, each with its own pool. One set
+// per decoding thread, kept by the System and re-used for every stack of
+// every sentence, so no threads are started on the search's hot path
+class SearchThreads
+{
+public:
+  SearchThreads(size_t numHelpers);
+  ~SearchThreads();
+
+  size_t GetSize() const {
+    return m_pools.size();
+  }
+  MemPool &GetPool(size_t ind) {
+    return *m_pools[ind];
+  }
+
+  // start of a sentence. The hypos of the previous one are no longer used
+  void Reset();
+
+  // run func on one of the helpers
+  void Submit(const boost::function<void()> &func);
+
+  // until everything submitted has run
+  void Wait();
+
+protected:
+  class Job;
+
+  ThreadPool m_threads;
+  std::vector<MemPool*> m_pools;
+
+  boost::mutex m_lock;
+  boost::condition_variable m_cond;
+  size_t m_pending;
+
+  void Done();
+};
+
 class Search: public Moses2::Search
 {
 public:
@@ -38,6 +81,34 @@ public:
 protected:
   Stacks m_stacks;
 
+  // search-algorithm 4 (NormalBatch). New hypos are collected here and
+  // evaluated together by the stateful FFs before being added to the stacks
+  Batch *m_batch;
+
+  // the time budget ran out. Stacks decoded after that are only extended
+  // from their best hypothesis. The hypotheses left out that way give the
+  // degradation
+  bool m_overBudget;
+  size_t m_numHypos, m_numHyposDropped;
+
+  // search-threads > 1. Each stack is expanded by several threads, each with
+  // its own pool and staging vector. The staging vectors are added to the
+  // stacks in the same order as the single-threaded search would
+  struct Extension {
+    const Hypothesis *hypo;
+    const InputPath *path;
+    const TargetPhrases *tps;
+    const Bitmap *newBitmap;
+    SCORE estimatedScore;
+  };
+
+  SearchThreads *m_threads; // NULL if 1 thread
+  std::vector<Extension> m_extensions;
+  std::vector<std::vector<Hypothesis*> > m_staging;
+
+  void DecodeParallel(const Hypotheses &hypos);
+  void ExtendRange(size_t threadInd, size_t begin, size_t end);
+
   void Decode(size_t stackInd);
   void Extend(const Hypothesis &hypo, const InputPath &path);
   void Extend(const Hypothesis &hypo, const TargetPhrases &tps,
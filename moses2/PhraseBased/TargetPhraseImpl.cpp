@@ -37,9 +37,6 @@ TargetPhraseImpl::TargetPhraseImpl(MemPool &pool, const PhraseTable &pt,
                                    const System &system, size_t size)
   :Moses2::TargetPhrase<Moses2::Word>(pool, pt, system, size)
 {
-  m_scores = new (pool.Allocate<Scores>()) Scores(system, pool,
-      system.featureFunctions.GetNumScores());
-
   size_t numWithPtData = system.featureFunctions.GetWithPhraseTableInd().size();
   ffData = new (pool.Allocate<void *>(numWithPtData)) void *[numWithPtData];
 }
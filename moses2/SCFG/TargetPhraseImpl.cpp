@@ -52,9 +52,6 @@ TargetPhraseImpl::TargetPhraseImpl(MemPool &pool,
   ,m_alignNonTerm(&AlignmentInfoCollection::Instance().GetEmptyAlignmentInfo())
 
 {
-  m_scores = new (pool.Allocate<Scores>()) Scores(system, pool,
-      system.featureFunctions.GetNumScores());
-
 }
 
 TargetPhraseImpl::~TargetPhraseImpl()
@@ -12,6 +12,7 @@
 #include "System.h"
 #include "FF/FeatureFunction.h"
 #include "TranslationModel/UnknownWordPenalty.h"
+#include "PhraseBased/Normal/Search.h"
 #include "legacy/Util2.h"
 #include "util/exception.hh"
 
@@ -35,6 +36,11 @@ System::System(const Parameter &paramsArg) :
   params.SetParameter(cpuAffinityOffset, "cpu-affinity-offset", -1);
   params.SetParameter(cpuAffinityOffsetIncr, "cpu-affinity-increment", 1);
 
+  size_t memPoolBudget, memPoolFreeList;
+  params.SetParameter<size_t>(memPoolBudget, "mem-pool-budget", 0);
+  params.SetParameter<size_t>(memPoolFreeList, "mem-pool-free-list", 0);
+  MemPool::SetBudget(memPoolBudget << 20, memPoolFreeList << 20);
+
   const PARAM_VEC *section;
 
   // output collectors
@@ -63,6 +69,9 @@ System::System(const Parameter &paramsArg) :
   LoadDecodeGraphBackoff();
   cerr << "END LoadDecodeGraphBackoff()" << endl;
 
+  // vocab of models is complete. Look it up without locking from now on
+  m_vocab.Freeze();
+
   UTIL_THROW_IF2(options.input.xml_policy == XmlConstraint, "XmlConstraint not supported");
 
   // max spans for scfg decoding
@@ -197,6 +206,18 @@ Batch &System::GetBatch(MemPool &pool) const
   return *obj;
 }
 
+NSNormal::SearchThreads &System::GetSearchThreads(size_t numHelpers) const
+{
+  NSNormal::SearchThreads *obj;
+  obj = m_searchThreads.get();
+  // search-threads can be changed per request by the server
+  if (obj == NULL || obj->GetSize() != numHelpers) {
+    obj = new NSNormal::SearchThreads(numHelpers);
+    m_searchThreads.reset(obj);
+  }
+  return *obj;
+}
+
 void System::IsPb()
 {
   switch (options.search.algo) {
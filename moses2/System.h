@@ -28,6 +28,10 @@ namespace NSCubePruning
 {
 class Stack;
 }
+namespace NSNormal
+{
+class SearchThreads;
+}
 
 class FeatureFunction;
 class StatefulFeatureFunction;
@@ -63,6 +67,9 @@ public:
 
   Batch &GetBatch(MemPool &pool) const;
 
+  // search-threads helpers of this decoding thread
+  NSNormal::SearchThreads &GetSearchThreads(size_t numHelpers) const;
+
 protected:
   mutable FactorCollection m_vocab;
   //mutable boost::thread_specific_ptr<MemPool> m_managerPool;
@@ -74,6 +81,7 @@ protected:
   //thread_local static MemPool d;
 
   mutable boost::thread_specific_ptr<Batch> m_batch;
+  mutable boost::thread_specific_ptr<NSNormal::SearchThreads> m_searchThreads;
 
   void LoadWeights();
   void LoadMappings();
@@ -6,6 +6,7 @@
  */
 #include <boost/foreach.hpp>
 #include "ProbingPT.h"
+#include "TargetPhrasesCache.h"
 #include "probingpt/querying.h"
 #include "probingpt/probing_hash_utils.h"
 #include "util/exception.hh"
@@ -70,6 +71,8 @@ std::pair<bool, uint64_t> ProbingPT::ActiveChartEntryProbing::GetKey(const SCFG:
 ProbingPT::ProbingPT(size_t startInd, const std::string &line)
   :PhraseTable(startInd, line)
   ,load_method(util::POPULATE_OR_READ)
+  ,m_dynamicCacheSize(0)
+  ,m_dynamicCache(NULL)
 {
   ReadParameters();
 }
@@ -77,11 +80,16 @@ ProbingPT::ProbingPT(size_t startInd, const std::string &line)
 ProbingPT::~ProbingPT()
 {
   delete m_engine;
+  delete m_dynamicCache;
 }
 
 void ProbingPT::Load(System &system)
 {
   m_engine = new probingpt::QueryEngine(m_path.c_str(), load_method);
+  if (!m_engine->logProb) {
+    cerr << "Warning: " << m_path << " stores probabilities, which are converted on every lookup. "
+         << "Binarize with --log-prob so scores are read in place" << endl;
+  }
 
   m_unkId = 456456546456;
 
@@ -138,6 +146,9 @@ void ProbingPT::Load(System &system)
 
   // cache
   CreateCache(system);
+  if (m_dynamicCacheSize && system.isPb) {
+    m_dynamicCache = new TargetPhrasesCache(m_dynamicCacheSize);
+  }
 }
 
 void ProbingPT::SetParameter(const std::string& key, const std::string& value)
@@ -156,6 +167,8 @@ void ProbingPT::SetParameter(const std::string& key, const std::string& value)
     } else {
       UTIL_THROW2("load method not supported" << value);
     }
+  } else if (key == "dynamic-cache-size") {
+    m_dynamicCacheSize = Scan<size_t>(value);
   } else {
     PhraseTable::SetParameter(key, value);
   }
@@ -226,12 +239,34 @@ TargetPhrases* ProbingPT::Lookup(const Manager &mgr, MemPool &pool,
     return tps;
   }
 
+  TargetPhrases *tps;
+  if (m_dynamicCache) {
+    if (m_dynamicCache->Find(keyStruct.second, tps)) {
+      return tps;
+    }
+
+    if (m_dynamicCache->Admit(keyStruct.second)) {
+      // seen before. Create in its own pool so the entry outlives the sentence
+      TargetPhrasesCache::EntryPtr entry(new TargetPhrasesCache::Entry());
+      entry->tps = CreateTargetPhrases(entry->pool, mgr.system, sourcePhrase,
+                                       keyStruct.second);
+      return m_dynamicCache->Add(keyStruct.second, entry);
+    }
+  }
+
   // query pt
-  TargetPhrases *tps = CreateTargetPhrases(pool, mgr.system, sourcePhrase,
-                       keyStruct.second);
+  tps = CreateTargetPhrases(pool, mgr.system, sourcePhrase,
+                            keyStruct.second);
   return tps;
 }
 
+void ProbingPT::CleanUpAfterSentenceProcessing() const
+{
+  if (m_dynamicCache) {
+    m_dynamicCache->ReleaseHeld();
+  }
+}
+
 std::pair<bool, uint64_t> ProbingPT::GetKey(const Phrase<Moses2::Word> &sourcePhrase) const
 {
   std::pair<bool, uint64_t> ret;
@@ -288,51 +323,56 @@ TargetPhrases *ProbingPT::CreateTargetPhrases(MemPool &pool,
   return tps;
 }
 
-TargetPhraseImpl *ProbingPT::CreateTargetPhrase(
-  MemPool &pool,
-  const System &system,
-  const char *&offset) const
+template<typename WORD>
+void ProbingPT::SetScores(MemPool &pool, const System &system,
+                          TargetPhrase<WORD> &tp, SCORE *scores) const
 {
-  probingpt::TargetPhraseInfo *tpInfo = (probingpt::TargetPhraseInfo*) offset;
-  size_t numRealWords = tpInfo->numWords / m_output.size();
-
-  TargetPhraseImpl *tp =
-    new (pool.Allocate<TargetPhraseImpl>()) TargetPhraseImpl(pool, *this,
-        system, numRealWords);
-
-  offset += sizeof(probingpt::TargetPhraseInfo);
-
-  // scores
-  SCORE *scores = (SCORE*) offset;
-
-  size_t totalNumScores = m_engine->num_scores + m_engine->num_lex_scores;
-
   if (m_engine->logProb) {
-    // set pt score for rule
-    tp->GetScores().PlusEquals(system, *this, scores);
+    // used in place, straight from the mapped file
+    tp.GetScores().PlusEquals(system, *this, scores);
 
     // save scores for other FF, eg. lex RO. Just give the offset
     if (m_engine->num_lex_scores) {
-      tp->scoreProperties = scores + m_engine->num_scores;
+      tp.scoreProperties = scores + m_engine->num_scores;
     }
   } else {
     // log score 1st
-    SCORE *logScores = (SCORE*) alloca(totalNumScores * sizeof(SCORE));
-    for (size_t i = 0; i < totalNumScores; ++i) {
+    SCORE *logScores = (SCORE*) alloca(m_engine->num_scores * sizeof(SCORE));
+    for (size_t i = 0; i < m_engine->num_scores; ++i) {
       logScores[i] = FloorScore(TransformScore(scores[i]));
     }
 
     // set pt score for rule
-    tp->GetScores().PlusEquals(system, *this, logScores);
+    tp.GetScores().PlusEquals(system, *this, logScores);
 
     // save scores for other FF, eg. lex RO.
-    tp->scoreProperties = pool.Allocate<SCORE>(m_engine->num_lex_scores);
-    for (size_t i = 0; i < m_engine->num_lex_scores; ++i) {
-      tp->scoreProperties[i] = logScores[i + m_engine->num_scores];
+    if (m_engine->num_lex_scores) {
+      tp.scoreProperties = pool.Allocate<SCORE>(m_engine->num_lex_scores);
+      for (size_t i = 0; i < m_engine->num_lex_scores; ++i) {
+        tp.scoreProperties[i] = FloorScore(TransformScore(scores[i + m_engine->num_scores]));
+      }
     }
   }
+}
 
-  offset += sizeof(SCORE) * totalNumScores;
+TargetPhraseImpl *ProbingPT::CreateTargetPhrase(
+  MemPool &pool,
+  const System &system,
+  const char *&offset) const
+{
+  probingpt::TargetPhraseInfo *tpInfo = (probingpt::TargetPhraseInfo*) offset;
+  size_t numRealWords = tpInfo->numWords / m_output.size();
+
+  TargetPhraseImpl *tp =
+    new (pool.Allocate<TargetPhraseImpl>()) TargetPhraseImpl(pool, *this,
+        system, numRealWords);
+
+  offset += sizeof(probingpt::TargetPhraseInfo);
+
+  // scores
+  SCORE *scores = (SCORE*) offset;
+  SetScores(pool, system, *tp, scores);
+  offset += sizeof(SCORE) * (m_engine->num_scores + m_engine->num_lex_scores);
 
   // words
   for (size_t targetPos = 0; targetPos < numRealWords; ++targetPos) {
@@ -609,35 +649,8 @@ SCFG::TargetPhraseImpl *ProbingPT::CreateTargetPhraseSCFG(
 
   // scores
   SCORE *scores = (SCORE*) offset;
-
-  size_t totalNumScores = m_engine->num_scores + m_engine->num_lex_scores;
-
-  if (m_engine->logProb) {
-    // set pt score for rule
-    tp->GetScores().PlusEquals(system, *this, scores);
-
-    // save scores for other FF, eg. lex RO. Just give the offset
-    if (m_engine->num_lex_scores) {
-      tp->scoreProperties = scores + m_engine->num_scores;
-    }
-  } else {
-    // log score 1st
-    SCORE *logScores = (SCORE*) alloca(totalNumScores * sizeof(SCORE));
-    for (size_t i = 0; i < totalNumScores; ++i) {
-      logScores[i] = FloorScore(TransformScore(scores[i]));
-    }
-
-    // set pt score for rule
-    tp->GetScores().PlusEquals(system, *this, logScores);
-
-    // save scores for other FF, eg. lex RO.
-    tp->scoreProperties = pool.Allocate<SCORE>(m_engine->num_lex_scores);
-    for (size_t i = 0; i < m_engine->num_lex_scores; ++i) {
-      tp->scoreProperties[i] = logScores[i + m_engine->num_scores];
-    }
-  }
-
-  offset += sizeof(SCORE) * totalNumScores;
+  SetScores(pool, system, *tp, scores);
+  offset += sizeof(SCORE) * (m_engine->num_scores + m_engine->num_lex_scores);
 
   // words
   for (size_t i = 0; i < tpInfo->numWords - 1; ++i) {
@@ -29,6 +29,7 @@ class AlignmentInfo;
 class MemPool;
 class System;
 class RecycleData;
+class TargetPhrasesCache;
 
 namespace SCFG
 {
@@ -78,6 +79,8 @@ public:
   virtual void SetParameter(const std::string& key, const std::string& value);
   void Lookup(const Manager &mgr, InputPathsBase &inputPaths) const;
 
+  virtual void CleanUpAfterSentenceProcessing() const;
+
   uint64_t GetUnk() const {
     return m_unkId;
   }
@@ -113,6 +116,11 @@ protected:
   TargetPhraseImpl *CreateTargetPhrase(MemPool &pool, const System &system,
                                        const char *&offset) const;
 
+  // rule & lex RO scores of a target phrase, from the mapped file
+  template<typename WORD>
+  void SetScores(MemPool &pool, const System &system,
+                 TargetPhrase<WORD> &tp, SCORE *scores) const;
+
   inline const std::pair<bool, const Factor*> *GetTargetFactor(uint32_t probingId) const {
     if (probingId >= m_targetVocab.size()) {
       return NULL;
@@ -136,6 +144,10 @@ protected:
 
   void CreateCache(System &system);
 
+  // filled while decoding, shared by all threads
+  size_t m_dynamicCacheSize; // 0 = no dynamic cache
+  TargetPhrasesCache *m_dynamicCache;
+
   void ReformatWord(System &system, std::string &wordStr, bool &isNT);
 
   // SCFG
@@ -0,0 +1,119 @@
+/*
+ * TargetPhrasesCache.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+#include "TargetPhrasesCache.h"
+
+using namespace std;
+
+namespace Moses2
+{
+
+TargetPhrasesCache::TargetPhrasesCache(size_t maxSize)
+  :m_maxShardSize(std::max<size_t>(maxSize / NUM_SHARDS, 1))
+{
+  for (size_t i = 0; i < NUM_SHARDS; ++i) {
+    m_shards[i].seen.resize(std::max<size_t>(m_maxShardSize * 8, 1024), false);
+  }
+}
+
+TargetPhrasesCache::~TargetPhrasesCache()
+{
+}
+
+bool TargetPhrasesCache::Find(uint64_t key, TargetPhrases *&tps) const
+{
+  Shard &shard = GetShard(key);
+  EntryPtr entry;
+  {
+    boost::mutex::scoped_lock lock(shard.mutex);
+    boost::unordered_map<uint64_t, size_t>::const_iterator iter = shard.index.find(key);
+    if (iter == shard.index.end()) {
+      return false;
+    }
+
+    Slot &slot = shard.slots[iter->second];
+    slot.referenced = true;
+    entry = slot.entry;
+  }
+
+  Hold(entry);
+  tps = entry->tps;
+  return true;
+}
+
+bool TargetPhrasesCache::Admit(uint64_t key) const
+{
+  Shard &shard = GetShard(key);
+  size_t bit = (key * 0x9E3779B97F4A7C15ULL >> 20) % shard.seen.size();
+
+  boost::mutex::scoped_lock lock(shard.mutex);
+  if (shard.seen[bit]) {
+    return true;
+  }
+
+  if (++shard.numSeen > shard.seen.size() / 2) {
+    shard.seen.assign(shard.seen.size(), false);
+    shard.numSeen = 1;
+  }
+  shard.seen[bit] = true;
+  return false;
+}
+
+TargetPhrases *TargetPhrasesCache::Add(uint64_t key, EntryPtr entry) const
+{
+  Shard &shard = GetShard(key);
+  EntryPtr evicted; // freed outside the lock
+  {
+    boost::mutex::scoped_lock lock(shard.mutex);
+    boost::unordered_map<uint64_t, size_t>::const_iterator iter = shard.index.find(key);
+    if (iter != shard.index.end()) {
+      // added by another thread
+      entry = shard.slots[iter->second].entry;
+    } else if (shard.slots.size() < m_maxShardSize) {
+      shard.index[key] = shard.slots.size();
+      Slot slot = { key, entry, false };
+      shard.slots.push_back(slot);
+    } else {
+      // clock. Give referenced entries a 2nd chance
+      while (shard.slots[shard.hand].referenced) {
+        shard.slots[shard.hand].referenced = false;
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+      }
+
+      Slot &slot = shard.slots[shard.hand];
+      shard.index.erase(slot.key);
+      evicted = slot.entry;
+
+      slot.key = key;
+      slot.entry = entry;
+      shard.index[key] = shard.hand;
+      shard.hand = (shard.hand + 1) % shard.slots.size();
+    }
+  }
+
+  Hold(entry);
+  return entry->tps;
+}
+
+void TargetPhrasesCache::Hold(const EntryPtr &entry) const
+{
+  std::vector<EntryPtr> *held = m_held.get();
+  if (held == NULL) {
+    held = new std::vector<EntryPtr>();
+    m_held.reset(held);
+  }
+  held->push_back(entry);
+}
+
+void TargetPhrasesCache::ReleaseHeld() const
+{
+  std::vector<EntryPtr> *held = m_held.get();
+  if (held) {
+    held->clear();
+  }
+}
+
+}
+
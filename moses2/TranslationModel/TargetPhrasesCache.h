@@ -0,0 +1,93 @@
+/*
+ * TargetPhrasesCache.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/unordered_map.hpp>
+#include "../MemPool.h"
+
+namespace Moses2
+{
+
+class TargetPhrases;
+
+/** Fully scored translation options of source phrases, filled while decoding
+ * and shared by all decoding threads.
+ * Each entry owns the pool its target phrases were created in, so it can be
+ * evicted independently. A thread keeps the entries it has looked up alive
+ * until ReleaseHeld() is called at the end of the sentence.
+ * Eviction is CLOCK. A key is only admitted the 2nd time it's looked up so
+ * that one-off phrases don't push out frequent ones.
+ */
+class TargetPhrasesCache
+{
+public:
+  struct Entry {
+    MemPool pool;
+    TargetPhrases *tps; // NULL = source phrase has no translations
+
+    Entry()
+      :pool(1000), tps(NULL) {
+    }
+  };
+  typedef boost::shared_ptr<Entry> EntryPtr;
+
+  TargetPhrasesCache(size_t maxSize);
+  virtual ~TargetPhrasesCache();
+
+  // true if cached. tps may be NULL if the phrase has no translations
+  bool Find(uint64_t key, TargetPhrases *&tps) const;
+
+  // whether a phrase not found in the cache should be created in an entry and added
+  bool Admit(uint64_t key) const;
+
+  // add, or return the entry another thread added in the meantime
+  TargetPhrases *Add(uint64_t key, EntryPtr entry) const;
+
+  // entries looked up by this thread may be freed after this
+  void ReleaseHeld() const;
+
+protected:
+  struct Slot {
+    uint64_t key;
+    EntryPtr entry;
+    bool referenced;
+  };
+
+  struct Shard {
+    boost::mutex mutex;
+    boost::unordered_map<uint64_t, size_t> index; // key -> slot
+    std::vector<Slot> slots;
+    size_t hand;
+
+    // keys seen once, by hash. Cleared when half full
+    std::vector<bool> seen;
+    size_t numSeen;
+
+    Shard()
+      :hand(0), numSeen(0) {
+    }
+  };
+
+  static const size_t NUM_SHARDS = 16;
+  size_t m_maxShardSize;
+  mutable Shard m_shards[NUM_SHARDS];
+
+  mutable boost::thread_specific_ptr<std::vector<EntryPtr> > m_held;
+
+  Shard &GetShard(uint64_t key) const {
+    return m_shards[(key ^ (key >> 32)) % NUM_SHARDS];
+  }
+
+  void Hold(const EntryPtr &entry) const;
+};
+
+}
+
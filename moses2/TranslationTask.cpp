@@ -34,6 +34,12 @@ void TranslationTask::Run()
   out = m_mgr->OutputBest() + "\n";
   m_mgr->system.bestCollector->Write(m_mgr->GetTranslationId(), out);
 
+  if (m_mgr->GetDegradation() > 0) {
+    cerr << "Translation " << m_mgr->GetTranslationId()
+         << ": search reduced by " << m_mgr->GetDegradation() * 100
+         << "% to stay within the time budget" << endl;
+  }
+
   if (m_mgr->system.options.nbest.nbest_size) {
     out = m_mgr->OutputNBest();
     m_mgr->system.nbestCollector->Write(m_mgr->GetTranslationId(), out);
@@ -35,53 +35,82 @@ using namespace std;
 namespace Moses2
 {
 
+const Factor *FactorCollection::FindFrozen(const StringPiece &factorString,
+    uint64_t hash, bool isNonTerminal) const
+{
+  if (m_frozen.empty()) return NULL;
+
+  for (size_t i = hash & m_frozenMask; ; i = (i + 1) & m_frozenMask) {
+    const FrozenEntry &entry = m_frozen[i];
+    if (entry.factor == NULL) return NULL;
+    if (entry.hash == hash
+        && (entry.factor->GetId() < moses_MaxNumNonterminals) == isNonTerminal
+        && entry.factor->GetString() == factorString) {
+      return entry.factor;
+    }
+  }
+}
+
 const Factor *FactorCollection::AddFactor(const StringPiece &factorString,
     const System &system, bool isNonTerminal)
 {
+  uint64_t hash = Hash(factorString);
+  const Factor *factor = FindFrozen(factorString, hash, isNonTerminal);
+  if (factor) return factor;
+
   FactorFriend to_ins;
   to_ins.in.m_string = factorString;
-  to_ins.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
+  Stripe &stripe = m_stripes[hash % NUM_STRIPES];
+  Set & set = (isNonTerminal) ? stripe.m_setNonTerminal : stripe.m_set;
   // If we're threaded, hope a read-only lock is sufficient.
 #ifdef WITH_THREADS
   {
     // read=lock scope
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+    boost::shared_lock<boost::shared_mutex> read_lock(stripe.m_accessLock);
     Set::const_iterator i = set.find(to_ins);
     if (i != set.end()) return &i->in;
   }
-  boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
+  boost::unique_lock<boost::shared_mutex> lock(stripe.m_accessLock);
 #endif // WITH_THREADS
-  std::pair<Set::iterator, bool> ret(set.insert(to_ins));
-  if (ret.second) {
-    ret.first->in.m_string.set(
-      memcpy(m_string_backing.Allocate(factorString.size()),
-             factorString.data(), factorString.size()), factorString.size());
+  Set::const_iterator i = set.find(to_ins);
+  if (i != set.end()) return &i->in;
+
+  {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock idLock(m_idLock);
+#endif
     if (isNonTerminal) {
-      m_factorIdNonTerminal++;
+      to_ins.in.m_id = m_factorIdNonTerminal++;
       UTIL_THROW_IF2(m_factorIdNonTerminal >= moses_MaxNumNonterminals,
                      "Number of non-terminals exceeds maximum size reserved. Adjust parameter moses_MaxNumNonterminals, then recompile");
     } else {
-      m_factorId++;
+      to_ins.in.m_id = m_factorId++;
     }
   }
 
-  const Factor *factor = &ret.first->in;
+  std::pair<Set::iterator, bool> ret(set.insert(to_ins));
+  ret.first->in.m_string.set(
+    memcpy(stripe.m_string_backing.Allocate(factorString.size()),
+           factorString.data(), factorString.size()), factorString.size());
 
-  return factor;
+  return &ret.first->in;
 }
 
 const Factor *FactorCollection::GetFactor(const StringPiece &factorString,
     bool isNonTerminal)
 {
+  uint64_t hash = Hash(factorString);
+  const Factor *factor = FindFrozen(factorString, hash, isNonTerminal);
+  if (factor) return factor;
+
   FactorFriend to_find;
   to_find.in.m_string = factorString;
-  to_find.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
+  const Stripe &stripe = m_stripes[hash % NUM_STRIPES];
+  const Set & set = (isNonTerminal) ? stripe.m_setNonTerminal : stripe.m_set;
   {
     // read=lock scope
 #ifdef WITH_THREADS
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+    boost::shared_lock<boost::shared_mutex> read_lock(stripe.m_accessLock);
 #endif // WITH_THREADS
     Set::const_iterator i = set.find(to_find);
     if (i != set.end()) return &i->in;
@@ -89,6 +118,45 @@ const Factor *FactorCollection::GetFactor(const StringPiece &factorString,
   return NULL;
 }
 
+void FactorCollection::Freeze()
+{
+  size_t size = 0;
+  for (size_t i = 0; i < NUM_STRIPES; ++i) {
+    size += m_stripes[i].m_set.size() + m_stripes[i].m_setNonTerminal.size();
+  }
+
+  // at most half full
+  size_t buckets = 1;
+  while (buckets < 2 * size) {
+    buckets <<= 1;
+  }
+
+  std::vector<FrozenEntry> frozen(buckets);
+  for (size_t i = 0; i < buckets; ++i) {
+    frozen[i].factor = NULL;
+  }
+  size_t mask = buckets - 1;
+
+  for (size_t i = 0; i < NUM_STRIPES; ++i) {
+    const Set *sets[2] = { &m_stripes[i].m_set, &m_stripes[i].m_setNonTerminal };
+    for (size_t j = 0; j < 2; ++j) {
+      for (Set::const_iterator iter = sets[j]->begin(); iter != sets[j]->end(); ++iter) {
+        const Factor *factor = &iter->in;
+        uint64_t hash = Hash(factor->GetString());
+        size_t bucket = hash & mask;
+        while (frozen[bucket].factor) {
+          bucket = (bucket + 1) & mask;
+        }
+        frozen[bucket].hash = hash;
+        frozen[bucket].factor = factor;
+      }
+    }
+  }
+
+  m_frozen.swap(frozen);
+  m_frozenMask = mask;
+}
+
 FactorCollection::~FactorCollection()
 {
 }
@@ -96,12 +164,15 @@ FactorCollection::~FactorCollection()
 // friend
 ostream& operator<<(ostream& out, const FactorCollection& factorCollection)
 {
+  for (size_t i = 0; i < FactorCollection::NUM_STRIPES; ++i) {
+    const FactorCollection::Stripe &stripe = factorCollection.m_stripes[i];
 #ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(factorCollection.m_accessLock);
+    boost::shared_lock<boost::shared_mutex> lock(stripe.m_accessLock);
 #endif
-  for (FactorCollection::Set::const_iterator i = factorCollection.m_set.begin();
-       i != factorCollection.m_set.end(); ++i) {
-    out << i->in;
+    for (FactorCollection::Set::const_iterator i = stripe.m_set.begin();
+         i != stripe.m_set.end(); ++i) {
+      out << i->in;
+    }
   }
   return out;
 }
@@ -27,6 +27,7 @@
 #endif
 
 #ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #endif
 
@@ -35,6 +36,8 @@
 
 #include <functional>
 #include <string>
+#include <vector>
+#include <stdint.h>
 
 #include "util/string_piece.hh"
 #include "util/pool.hh"
@@ -83,24 +86,56 @@ class FactorCollection
     }
   };
   typedef boost::unordered_set<FactorFriend, HashFactor, EqualsFactor> Set;
-  Set m_set;
-  Set m_setNonTerminal;
-
-  util::Pool m_string_backing;
 
+  /** Factors are spread over stripes by hash so that threads adding unknown
+   * words don't all wait on the same lock.
+   */
+  struct Stripe {
+    Set m_set;
+    Set m_setNonTerminal;
+    util::Pool m_string_backing;
 #ifdef WITH_THREADS
-  //reader-writer lock
-  mutable boost::shared_mutex m_accessLock;
+    //reader-writer lock
+    mutable boost::shared_mutex m_accessLock;
 #endif
+  };
+  static const size_t NUM_STRIPES = 64;
+  Stripe m_stripes[NUM_STRIPES];
+
+  /** Open-addressing snapshot of every factor known when Freeze() was called,
+   * ie. the vocab of the phrase-tables & LMs. Never changes afterwards so it's
+   * read without locks. Empty until frozen
+   */
+  struct FrozenEntry {
+    uint64_t hash;
+    const Factor *factor;
+  };
+  std::vector<FrozenEntry> m_frozen;
+  size_t m_frozenMask;
 
+#ifdef WITH_THREADS
+  boost::mutex m_idLock;
+#endif
   size_t m_factorIdNonTerminal; /**< unique, contiguous ids, starting from 0, for each non-terminal factor */
   size_t m_factorId; /**< unique, contiguous ids, starting from moses_MaxNumNonterminals, for each terminal factor */
 
   //! constructor. only the 1 static variable can be created
   FactorCollection() :
-    m_factorIdNonTerminal(0), m_factorId(moses_MaxNumNonterminals) {
+    m_frozenMask(0), m_factorIdNonTerminal(0), m_factorId(moses_MaxNumNonterminals) {
   }
 
+  static uint64_t Hash(const StringPiece &factorString) {
+    return util::MurmurHashNative(factorString.data(), factorString.size());
+  }
+
+  const Factor *FindFrozen(const StringPiece &factorString, uint64_t hash,
+                           bool isNonTerminal) const;
+
+  /** build the lock-free snapshot. Must be called before decoding threads
+   * start, factors added later go to the stripes only
+   */
+  void Freeze();
+
 public:
   ~FactorCollection();
 
@@ -111,6 +146,9 @@ public:
                           bool isNonTerminal);
 
   size_t GetNumNonTerminals() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_idLock);
+#endif
     return m_factorIdNonTerminal;
   }
 
@@ -87,6 +87,8 @@ Parameter::Parameter()
   //    "threshold for constructing hypotheses based on estimate cost");
   AddParam(search_opts, "stack", "s",
            "maximum stack size for histogram pruning. 0 = unlimited stack size");
+  AddParam(search_opts, "search-threads",
+           "number of threads extending each stack of a sentence. Normal search only (default 1)");
   //AddParam(search_opts, "stack-diversity", "sd",
   //    "minimum number of hypothesis of each coverage in stack (default 0)");
 
@@ -124,6 +126,8 @@ Parameter::Parameter()
   //    "if present, allow dropping of source words"); //da = drop any (word); see -du for comparison
   AddParam(search_opts, "threads", "th",
            "number of threads to use in decoding (defaults to single-threaded)");
+  AddParam(search_opts, "longest-first",
+           "in batch mode, read all input and decode the longest sentences first. Output is still in input order");
 
   // distortion options
   po::options_description disto_opts("Distortion options");
@@ -144,6 +148,10 @@ Parameter::Parameter()
            "How many hypotheses should be created for each coverage. (default = 0)");
   AddParam(cube_opts, "cube-pruning-lazy-scoring", "cbls",
            "Don't fully score a hypothesis until it is popped");
+  AddParam(cube_opts, "cube-pruning-time-budget", "cbtb",
+           "Milliseconds each sentence may take. Pop limit shrinks as decoding approaches it. (default = 0, no limit)");
+  AddParam(cube_opts, "cube-pruning-min-pop-limit", "cbmp",
+           "Smallest pop limit the time budget can shrink a stack to. (default = 10)");
   //AddParam(cube_opts, "cube-pruning-deterministic-search", "cbds",
   //    "Break ties deterministically during search");
 
@@ -308,6 +316,16 @@ Parameter::Parameter()
            "Max. number of seconds the server will keep a persistent connection alive.");
   AddParam(server_opts,"server-timeout",
            "Max. number of seconds the server will wait for a client to submit a request once a connection has been established.");
+  AddParam(server_opts,"server-max-queue",
+           "Max. No. of sentences queued or being translated. Requests beyond that are refused (default 0 = no limit).");
+  AddParam(server_opts,"server-request-timeout",
+           "Max. number of seconds from accepting a request to answering it, including time in the queue. The search is cut short to keep to it (default 0 = no limit).");
+  AddParam(server_opts,"server-result-timeout",
+           "Max. number of seconds the result of an async request is kept for the client to collect it (default 600, 0 = no limit).");
+  AddParam(server_opts,"server-client-max-running",
+           "Max. No. of sentences of one client translated at the same time (default 0 = no limit).");
+  AddParam(server_opts,"server-client-weights",
+           "Share of the translation threads given to each client id, e.g. 'web=4,batch=1'. Other clients have weight 1.");
 
   po::options_description irstlm_opts("IRSTLM Options");
   //AddParam(irstlm_opts, "clean-lm-cache",
@@ -358,6 +376,10 @@ Parameter::Parameter()
   AddParam(misc_opts, "cpu-affinity-offset", "CPU Affinity. Default = -1 (no affinity)");
   AddParam(misc_opts, "cpu-affinity-increment",
            "Set to 1 (default) to put each thread on different cores. 0 to run all threads on one core");
+  AddParam(misc_opts, "mem-pool-budget",
+           "MB of memory each thread's pool keeps between sentences. Default = 0 (keep everything)");
+  AddParam(misc_opts, "mem-pool-free-list",
+           "MB of released pool memory kept for re-use by all threads. Default = 0 (free it)");
 
   // Compact phrase table and reordering table.
   po::options_description cpt_opts(
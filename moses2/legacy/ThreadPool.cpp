@@ -40,8 +40,18 @@ namespace Moses2
 
 ThreadPool::ThreadPool(size_t numThreads, int cpuAffinityOffset,
                        int cpuAffinityIncr) :
-  m_stopped(false), m_stopping(false), m_queueLimit(numThreads*2)
+  m_nextWorker(0), m_numTasks(0), m_stopped(false), m_stopping(false)
 {
+  // jobs are dealt onto the threads' queues, so there must be one
+  if (numThreads == 0) {
+    numThreads = 1;
+  }
+  m_queueLimit = numThreads * 2;
+
+  for (size_t i = 0; i < numThreads; ++i) {
+    m_workers.push_back(new Worker());
+  }
+
 #if defined(_WIN32) || defined(_WIN64)
   size_t numCPU = std::thread::hardware_concurrency();
 #else
@@ -53,7 +63,7 @@ ThreadPool::ThreadPool(size_t numThreads, int cpuAffinityOffset,
 
   for (size_t i = 0; i < numThreads; ++i) {
     boost::thread *thread = m_threads.create_thread(
-                              boost::bind(&ThreadPool::Execute, this));
+                              boost::bind(&ThreadPool::Execute, this, i));
 
 #ifdef __linux
     if (cpuAffinityOffset >= 0) {
@@ -89,42 +99,87 @@ ThreadPool::ThreadPool(size_t numThreads, int cpuAffinityOffset,
   }
 }
 
-void ThreadPool::Execute()
+ThreadPool::~ThreadPool()
+{
+  Stop();
+  for (size_t i = 0; i < m_workers.size(); ++i) {
+    delete m_workers[i];
+  }
+}
+
+void ThreadPool::Execute(size_t workerInd)
 {
   do {
     boost::shared_ptr<Task> task;
-    {
-      // Find a job to perform
+    if (!m_stopped && Pop(workerInd, task)) {
+      boost::mutex::scoped_lock lock(m_mutex);
+      --m_numTasks;
+    } else {
+      // Nothing to do. Wait for a job unless one is being pushed right now
       boost::mutex::scoped_lock lock(m_mutex);
-      if (m_tasks.empty() && !m_stopped) {
+      if (m_numTasks == 0 && !m_stopped) {
         m_threadNeeded.wait(lock);
+      } else if (!m_stopped) {
+        // another thread has popped the last job but not yet counted it.
+        // Let it run rather than spin on the lock
+        lock.unlock();
+        boost::this_thread::yield();
       }
-      if (!m_stopped && !m_tasks.empty()) {
-        task = m_tasks.front();
-        m_tasks.pop();
-      }
+      continue;
     }
+
     //Execute job
-    if (task) {
-      // must read from task before run. otherwise task may be deleted by main thread
-      // race condition
-      task->DeleteAfterExecution();
-      task->Run();
-    }
+    // must read from task before run. otherwise task may be deleted by main thread
+    // race condition
+    task->DeleteAfterExecution();
+    task->Run();
+
     m_threadAvailable.notify_all();
   } while (!m_stopped);
 }
 
+bool ThreadPool::Pop(size_t workerInd, boost::shared_ptr<Task> &task)
+{
+  {
+    Worker &worker = *m_workers[workerInd];
+    boost::mutex::scoped_lock lock(worker.mutex);
+    if (!worker.tasks.empty()) {
+      task = worker.tasks.front();
+      worker.tasks.pop_front();
+      return true;
+    }
+  }
+
+  // steal
+  for (size_t i = 1; i < m_workers.size(); ++i) {
+    Worker &victim = *m_workers[(workerInd + i) % m_workers.size()];
+    boost::mutex::scoped_lock lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.back();
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
 void ThreadPool::Submit(boost::shared_ptr<Task> task)
 {
   boost::mutex::scoped_lock lock(m_mutex);
   if (m_stopping) {
     throw runtime_error("ThreadPool stopping - unable to accept new jobs");
   }
-  while (m_queueLimit > 0 && m_tasks.size() >= m_queueLimit) {
+  while (m_queueLimit > 0 && m_numTasks >= m_queueLimit) {
     m_threadAvailable.wait(lock);
   }
-  m_tasks.push(task);
+
+  Worker &worker = *m_workers[m_nextWorker];
+  m_nextWorker = (m_nextWorker + 1) % m_workers.size();
+  {
+    boost::mutex::scoped_lock workerLock(worker.mutex);
+    worker.tasks.push_back(task);
+  }
+  ++m_numTasks;
   m_threadNeeded.notify_all();
 }
 
@@ -139,7 +194,7 @@ void ThreadPool::Stop(bool processRemainingJobs)
   if (processRemainingJobs) {
     boost::mutex::scoped_lock lock(m_mutex);
     //wait for queue to drain.
-    while (!m_tasks.empty() && !m_stopped) {
+    while (m_numTasks && !m_stopped) {
       m_threadAvailable.wait(lock);
     }
   }
@@ -22,7 +22,7 @@
 #pragma once
 
 #include <iostream>
-#include <queue>
+#include <deque>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
@@ -62,17 +62,16 @@ class ThreadPool
 {
 public:
   /**
-   * Construct a thread pool of a fixed size.
+   * Construct a thread pool of a fixed size. 0 threads means 1.
    **/
   explicit ThreadPool(size_t numThreads, int cpuAffinityOffset = -1,
                       int cpuAffinityIncr = 1);
 
-  ~ThreadPool() {
-    Stop();
-  }
+  ~ThreadPool();
 
   /**
-   * Add a job to the threadpool.
+   * Add a job to the threadpool. Jobs are dealt round-robin onto the
+   * per-thread queues; idle threads steal from the back of the others.
    **/
   void Submit(boost::shared_ptr<Task> task);
 
@@ -90,12 +89,26 @@ public:
   }
 
 private:
+  struct Worker {
+    std::deque<boost::shared_ptr<Task> > tasks;
+    boost::mutex mutex;
+  };
+
   /**
    * The main loop executed by each thread.
    **/
-  void Execute();
+  void Execute(size_t workerInd);
+
+  /**
+   * Take the next job from the front of this thread's queue, or steal one
+   * from the back of another thread's queue.
+   **/
+  bool Pop(size_t workerInd, boost::shared_ptr<Task> &task);
+
+  std::vector<Worker*> m_workers;
+  size_t m_nextWorker;
+  size_t m_numTasks; // queued, not yet taken. Guarded by m_mutex
 
-  std::queue<boost::shared_ptr<Task> > m_tasks;
   boost::thread_group m_threads;
   boost::mutex m_mutex;
   boost::condition_variable m_threadNeeded;
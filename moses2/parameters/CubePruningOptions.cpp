@@ -10,6 +10,8 @@ CubePruningOptions::
 CubePruningOptions()
   : pop_limit(DEFAULT_CUBE_PRUNING_POP_LIMIT)
   , diversity(DEFAULT_CUBE_PRUNING_DIVERSITY)
+  , time_budget(0)
+  , min_pop_limit(DEFAULT_CUBE_PRUNING_MIN_POP_LIMIT)
   , lazy_scoring(false)
   , deterministic_search(false)
 {}
@@ -22,6 +24,9 @@ init(Parameter const& param)
                      DEFAULT_CUBE_PRUNING_POP_LIMIT);
   param.SetParameter(diversity, "cube-pruning-diversity",
                      DEFAULT_CUBE_PRUNING_DIVERSITY);
+  param.SetParameter(time_budget, "cube-pruning-time-budget", (size_t) 0);
+  param.SetParameter(min_pop_limit, "cube-pruning-min-pop-limit",
+                     DEFAULT_CUBE_PRUNING_MIN_POP_LIMIT);
   param.SetParameter(lazy_scoring, "cube-pruning-lazy-scoring", false);
   //param.SetParameter(deterministic_search, "cube-pruning-deterministic-search", false);
   return true;
@@ -40,6 +45,12 @@ update(std::map<std::string,xmlrpc_c::value>const& params)
   si = params.find("cube-pruning-diversity");
   if (si != params.end()) diversity = xmlrpc_c::value_int(si->second);
 
+  si = params.find("cube-pruning-time-budget");
+  if (si != params.end()) time_budget = xmlrpc_c::value_int(si->second);
+
+  si = params.find("cube-pruning-min-pop-limit");
+  if (si != params.end()) min_pop_limit = xmlrpc_c::value_int(si->second);
+
   si = params.find("cube-pruning-lazy-scoring");
   if (si != params.end()) {
     std::string spec = xmlrpc_c::value_string(si->second);
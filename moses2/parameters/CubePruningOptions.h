@@ -10,6 +10,8 @@ struct
     CubePruningOptions : public OptionsBaseClass {
   size_t  pop_limit;
   size_t  diversity;
+  size_t  time_budget; // ms per sentence. 0 = no limit
+  size_t  min_pop_limit;
   bool lazy_scoring;
   bool deterministic_search;
 
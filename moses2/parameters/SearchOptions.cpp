@@ -15,6 +15,7 @@ SearchOptions()
   , max_trans_opt_per_cov(DEFAULT_MAX_TRANS_OPT_SIZE)
   , max_partial_trans_opt(DEFAULT_MAX_PART_TRANS_OPT_SIZE)
   , beam_width(DEFAULT_BEAM_WIDTH)
+  , search_threads(1)
   , timeout(0)
   , consensus(false)
   , early_discarding_threshold(DEFAULT_EARLY_DISCARDING_THRESHOLD)
@@ -36,6 +37,7 @@ init(Parameter const& param)
   param.SetParameter(stack_size, "stack", DEFAULT_MAX_HYPOSTACK_SIZE);
   param.SetParameter(stack_diversity, "stack-diversity", size_t(0));
   param.SetParameter(beam_width, "beam-threshold", DEFAULT_BEAM_WIDTH);
+  param.SetParameter(search_threads, "search-threads", size_t(1));
   param.SetParameter(early_discarding_threshold, "early-discarding-threshold",
                      DEFAULT_EARLY_DISCARDING_THRESHOLD);
   param.SetParameter(timeout, "time-out", 0);
@@ -99,6 +101,9 @@ update(std::map<std::string,xmlrpc_c::value>const& params)
   si = params.find("max-phrase-length");
   if (si != params.end()) max_phrase_length = xmlrpc_c::value_int(si->second);
 
+  si = params.find("search-threads");
+  if (si != params.end()) search_threads = xmlrpc_c::value_int(si->second);
+
   return true;
 }
 #endif
@@ -25,6 +25,9 @@ struct
   // beam search
   float beam_width;
 
+  // threads expanding a single stack
+  size_t search_threads;
+
   int timeout;
 
   bool consensus; //! Use Consensus decoding  (DeNero et al 2009)
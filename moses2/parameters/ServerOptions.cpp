@@ -46,6 +46,10 @@ ServerOptions()
   , keepaliveTimeout(15)
   , keepaliveMaxConn(30)
   , timeout(15)
+  , maxQueue(0)
+  , requestTimeout(0)
+  , resultTimeout(600)
+  , maxRunningPerClient(0)
 { }
 
 ServerOptions::
@@ -72,6 +76,22 @@ init(Parameter const& P)
   P.SetParameter(this->keepaliveMaxConn,"server-keepalive-maxconn", 30);
   P.SetParameter(this->timeout,"server-timeout",15);
 
+  // admission control and time limits of translation requests
+  P.SetParameter(this->maxQueue, "server-max-queue", size_t(0));
+  P.SetParameter(this->requestTimeout, "server-request-timeout", 0.0);
+  P.SetParameter(this->resultTimeout, "server-result-timeout", 600.0);
+
+  // scheduling between clients
+  P.SetParameter(this->maxRunningPerClient, "server-client-max-running", size_t(0));
+  std::string weights_spec;
+  P.SetParameter(weights_spec, "server-client-weights", std::string(""));
+  BOOST_FOREACH(const std::string &spec, Tokenize(weights_spec, ",")) {
+    std::vector<std::string> toks = Tokenize(spec, "=");
+    UTIL_THROW_IF2(toks.size() != 2 || Scan<float>(toks[1]) <= 0,
+                   "Can't parse client weight '" << spec << "'");
+    this->clientWeights[toks[0]] = Scan<float>(toks[1]);
+  }
+
   // the stuff below is related to Moses translation sessions
   std::string timeout_spec;
   P.SetParameter(timeout_spec, "session-timeout",std::string("30m"));
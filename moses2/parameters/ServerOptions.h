@@ -27,6 +27,13 @@ struct
   int keepaliveMaxConn;  // this is for the abyss server
   int timeout;           // this is for the abyss server
 
+  size_t maxQueue;       // sentences queued or being decoded, 0 = no limit
+  double requestTimeout; // seconds until a request is answered, 0 = no limit
+  double resultTimeout;  // seconds an async result waits to be collected, 0 = forever
+
+  size_t maxRunningPerClient; // sentences a client may have decoding at once, 0 = no limit
+  std::map<std::string, float> clientWeights; // share of the threads per client id, default 1
+
   bool init(Parameter const& param);
   ServerOptions(Parameter const& param);
   ServerOptions();
@@ -0,0 +1,233 @@
+/*
+ * Scheduler.cpp
+ *
+ * Decides which queued sentence the translation threads decode next.
+ */
+#include <algorithm>
+#include "Scheduler.h"
+#include "../parameters/ServerOptions.h"
+#include "util/usage.hh"
+
+using namespace std;
+
+namespace Moses2
+{
+
+/** A queued sentence. Tells the scheduler when decoding starts and ends */
+class Scheduler::Job : public Task
+{
+public:
+  Job(Scheduler &scheduler, boost::shared_ptr<Task> task,
+      const std::string &clientId, Priority priority, double finish)
+    :m_scheduler(scheduler)
+    ,m_task(task)
+    ,m_clientId(clientId)
+    ,m_priority(priority)
+    ,m_finish(finish)
+    ,m_submitted(util::WallTime())
+    ,m_started(0) {
+  }
+
+  virtual void Run() {
+    m_scheduler.Started(*this);
+    m_task->Run();
+    m_scheduler.Finished(*this);
+  }
+
+  virtual bool DeleteAfterExecution() {
+    return false;
+  }
+
+  Scheduler &m_scheduler;
+  boost::shared_ptr<Task> m_task;
+  std::string m_clientId;
+  Priority m_priority;
+  double m_finish; // virtual finish time, for fair queuing
+  double m_submitted, m_started;
+};
+
+Scheduler::Stats::Stats()
+  :numQueued(0)
+  ,numRunning(0)
+  ,numDone(0)
+  ,totalWait(0)
+  ,maxWait(0)
+  ,totalLatency(0)
+  ,maxLatency(0)
+{
+}
+
+Scheduler::Scheduler(const ServerOptions &options, int cpuAffinityOffset,
+                     int cpuAffinityIncr)
+  :m_options(options)
+  ,m_threadPool(options.numThreads, cpuAffinityOffset, cpuAffinityIncr)
+  ,m_numThreads(options.numThreads)
+  ,m_numRunning(0)
+{
+  for (size_t i = 0; i < NumPriorities; ++i) {
+    m_virtualTime[i] = 0;
+  }
+}
+
+Scheduler::~Scheduler()
+{
+}
+
+bool Scheduler::ParsePriority(const std::string &name, Priority &priority)
+{
+  if (name == "interactive") {
+    priority = Interactive;
+  } else if (name == "bulk") {
+    priority = Bulk;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+float Scheduler::GetWeight(const std::string &clientId) const
+{
+  std::map<std::string, float>::const_iterator iter = m_options.clientWeights.find(clientId);
+  return iter == m_options.clientWeights.end() ? 1 : iter->second;
+}
+
+void Scheduler::Submit(boost::shared_ptr<Task> task, const std::string &clientId,
+                       Priority priority, size_t cost)
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+
+  // a client that has been idle starts at the current virtual time, it
+  // doesn't get credit for the time it wasn't competing
+  Client &client = m_clients[priority][clientId];
+  double start = std::max(m_virtualTime[priority], client.lastFinish);
+  client.lastFinish = start + std::max(cost, (size_t) 1) / GetWeight(clientId);
+
+  boost::shared_ptr<Job> job(new Job(*this, task, clientId, priority, client.lastFinish));
+  client.queue.push_back(job);
+  ++m_stats[priority].numQueued;
+
+  Dispatch();
+}
+
+void Scheduler::Dispatch()
+{
+  size_t maxRunning = m_options.maxRunningPerClient;
+
+  while (m_numRunning < m_numThreads) {
+    // highest priority first, then the queue head that would finish first
+    // in a fair share of the threads
+    Client *next = NULL;
+    size_t priority;
+    for (priority = 0; priority < NumPriorities && next == NULL; ++priority) {
+      Clients &clients = m_clients[priority];
+      for (Clients::iterator iter = clients.begin(); iter != clients.end(); ++iter) {
+        Client &client = iter->second;
+        if (client.queue.empty() || (maxRunning && client.numRunning >= maxRunning)) {
+          continue;
+        }
+        if (next == NULL || client.queue.front()->m_finish < next->queue.front()->m_finish) {
+          next = &client;
+        }
+      }
+    }
+    if (next == NULL) {
+      // nothing queued, or only for clients at their limit
+      break;
+    }
+    --priority;
+
+    boost::shared_ptr<Job> job = next->queue.front();
+    next->queue.pop_front();
+    m_virtualTime[priority] = job->m_finish;
+    ++next->numRunning;
+    ++m_numRunning;
+    --m_stats[priority].numQueued;
+    ++m_stats[priority].numRunning;
+
+    m_threadPool.Submit(job);
+  }
+}
+
+void Scheduler::Started(Job &job)
+{
+  job.m_started = util::WallTime();
+}
+
+void Scheduler::Finished(Job &job)
+{
+  double now = util::WallTime();
+
+  boost::mutex::scoped_lock lock(m_mutex);
+
+  Stats &stats = m_stats[job.m_priority];
+  double wait = job.m_started - job.m_submitted;
+  double latency = now - job.m_submitted;
+  --stats.numRunning;
+  ++stats.numDone;
+  stats.totalWait += wait;
+  stats.maxWait = std::max(stats.maxWait, wait);
+  stats.totalLatency += latency;
+  stats.maxLatency = std::max(stats.maxLatency, latency);
+
+  Clients &clients = m_clients[job.m_priority];
+  Clients::iterator iter = clients.find(job.m_clientId);
+  --iter->second.numRunning;
+  if (iter->second.queue.empty() && iter->second.numRunning == 0) {
+    clients.erase(iter);
+  }
+  --m_numRunning;
+
+  Dispatch();
+}
+
+std::map<std::string, xmlrpc_c::value> Scheduler::GetStats() const
+{
+  static const char *names[NumPriorities] = { "interactive", "bulk" };
+
+  boost::mutex::scoped_lock lock(m_mutex);
+
+  std::map<std::string, xmlrpc_c::value> ret;
+  ret["threads"] = xmlrpc_c::value_int(m_numThreads);
+  ret["running"] = xmlrpc_c::value_int(m_numRunning);
+
+  std::map<std::string, xmlrpc_c::value> clientsRet;
+  for (size_t priority = 0; priority < NumPriorities; ++priority) {
+    const Stats &stats = m_stats[priority];
+    std::map<std::string, xmlrpc_c::value> statsRet;
+    statsRet["queued"] = xmlrpc_c::value_int(stats.numQueued);
+    statsRet["running"] = xmlrpc_c::value_int(stats.numRunning);
+    statsRet["done"] = xmlrpc_c::value_int(stats.numDone);
+    statsRet["mean-wait"] = xmlrpc_c::value_double(stats.numDone ? stats.totalWait / stats.numDone : 0);
+    statsRet["max-wait"] = xmlrpc_c::value_double(stats.maxWait);
+    statsRet["mean-latency"] = xmlrpc_c::value_double(stats.numDone ? stats.totalLatency / stats.numDone : 0);
+    statsRet["max-latency"] = xmlrpc_c::value_double(stats.maxLatency);
+    ret[names[priority]] = xmlrpc_c::value_struct(statsRet);
+
+    const Clients &clients = m_clients[priority];
+    for (Clients::const_iterator iter = clients.begin(); iter != clients.end(); ++iter) {
+      std::map<std::string, xmlrpc_c::value> clientRet;
+      clientRet["priority"] = xmlrpc_c::value_string(names[priority]);
+      clientRet["queued"] = xmlrpc_c::value_int(iter->second.queue.size());
+      clientRet["running"] = xmlrpc_c::value_int(iter->second.numRunning);
+      clientsRet[iter->first + "/" + names[priority]] = xmlrpc_c::value_struct(clientRet);
+    }
+  }
+  ret["clients"] = xmlrpc_c::value_struct(clientsRet);
+
+  return ret;
+}
+
+SchedulerStats::SchedulerStats(const Scheduler &scheduler)
+  :m_scheduler(scheduler)
+{
+  this->_signature = "S:";
+  this->_help = "Queue depths, running sentences and latencies of the translation scheduler";
+}
+
+void SchedulerStats::execute(xmlrpc_c::paramList const& paramList,
+                             xmlrpc_c::value *   const  retvalP)
+{
+  *retvalP = xmlrpc_c::value_struct(m_scheduler.GetStats());
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+ * Scheduler.h
+ *
+ * Decides which queued sentence the translation threads decode next.
+ */
+#pragma once
+#include <string>
+#include <map>
+#include <deque>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <xmlrpc-c/base.hpp>
+#include <xmlrpc-c/registry.hpp>
+#include "../legacy/ThreadPool.h"
+
+namespace Moses2
+{
+class ServerOptions;
+
+/** Sits between the Translator and the translation threads. Sentences wait
+ * in one queue per client and priority class, and only as many as there
+ * are threads are handed to the thread pool, so a large batch can't fill
+ * the pool ahead of everyone else.
+ * Interactive sentences always go before bulk ones. Within a class, clients
+ * share the threads in proportion to their weights (self-clocked weighted
+ * fair queuing, with sentence length as the cost), and no client has more
+ * than server-client-max-running sentences decoding at once.
+ */
+class Scheduler
+{
+public:
+  enum Priority {
+    Interactive = 0,
+    Bulk = 1,
+    NumPriorities = 2
+  };
+
+  Scheduler(const ServerOptions &options, int cpuAffinityOffset = -1,
+            int cpuAffinityIncr = 1);
+  virtual ~Scheduler();
+
+  // queue a sentence for translation. cost is its length in words
+  void Submit(boost::shared_ptr<Task> task, const std::string &clientId,
+              Priority priority, size_t cost);
+
+  // queue depths, running sentences and latencies per priority class and client
+  std::map<std::string, xmlrpc_c::value> GetStats() const;
+
+  // false if the name isn't a priority class
+  static bool ParsePriority(const std::string &name, Priority &priority);
+
+protected:
+  class Job;
+
+  struct Client {
+    std::deque<boost::shared_ptr<Job> > queue;
+    double lastFinish; // virtual finish time of the last sentence queued
+    size_t numRunning;
+    Client() : lastFinish(0), numRunning(0) {
+    }
+  };
+  typedef std::map<std::string, Client> Clients;
+
+  struct Stats {
+    size_t numQueued, numRunning, numDone;
+    double totalWait, maxWait; // seconds from Submit() to start of decoding
+    double totalLatency, maxLatency; // seconds from Submit() to end of decoding
+    Stats();
+  };
+
+  const ServerOptions &m_options;
+  ThreadPool m_threadPool;
+  size_t m_numThreads;
+
+  mutable boost::mutex m_mutex;
+  Clients m_clients[NumPriorities];
+  double m_virtualTime[NumPriorities];
+  size_t m_numRunning;
+  Stats m_stats[NumPriorities];
+
+  float GetWeight(const std::string &clientId) const;
+
+  void Started(Job &job);
+  void Finished(Job &job);
+
+  // hand queued sentences to the thread pool while threads are free.
+  // Needs m_mutex
+  void Dispatch();
+};
+
+/** Reports the scheduler's statistics, for monitoring */
+class SchedulerStats : public xmlrpc_c::method
+{
+public:
+  SchedulerStats(const Scheduler &scheduler);
+
+  void execute(xmlrpc_c::paramList const& paramList,
+               xmlrpc_c::value *   const  retvalP);
+
+protected:
+  const Scheduler &m_scheduler;
+};
+
+}
@@ -17,9 +17,15 @@ namespace Moses2
 
 Server::Server(ServerOptions &server_options, System &system)
   :m_server_options(server_options)
+  ,m_scheduler(server_options, system.cpuAffinityOffset, system.cpuAffinityOffsetIncr)
   ,m_translator(new Translator(*this, system))
+  ,m_stats(new SchedulerStats(m_scheduler))
+  ,m_result(new TranslationResult(*static_cast<Translator*>(m_translator.get())))
 {
   m_registry.addMethod("translate", m_translator);
+  m_registry.addMethod("translate_batch", m_translator);
+  m_registry.addMethod("server_stats", m_stats);
+  m_registry.addMethod("translate_result", m_result);
 }
 
 Server::~Server()
@@ -68,5 +74,10 @@ ServerOptions const&Server::options() const
   return m_server_options;
 }
 
+Scheduler &Server::scheduler()
+{
+  return m_scheduler;
+}
+
 
 } /* namespace Moses2 */
@@ -9,6 +9,7 @@
 #include <xmlrpc-c/base.hpp>
 #include <xmlrpc-c/registry.hpp>
 #include <xmlrpc-c/server_abyss.hpp>
+#include "Scheduler.h"
 
 namespace Moses2
 {
@@ -27,11 +28,17 @@ public:
   ServerOptions const&
   options() const;
 
+  Scheduler&
+  scheduler();
+
 protected:
   ServerOptions &m_server_options;
   std::string m_pidfile;
   xmlrpc_c::registry m_registry;
+  Scheduler m_scheduler;
   xmlrpc_c::methodPtr const m_translator;
+  xmlrpc_c::methodPtr const m_stats;
+  xmlrpc_c::methodPtr const m_result;
 
 };
 
@@ -2,6 +2,7 @@
 #include "TranslationRequest.h"
 #include "../ManagerBase.h"
 #include "../System.h"
+#include "util/usage.hh"
 
 using namespace std;
 
@@ -9,31 +10,37 @@ namespace Moses2
 {
 TranslationRequest::
 TranslationRequest(xmlrpc_c::paramList const& paramList,
-                   boost::condition_variable& cond,
-                   boost::mutex& mut,
+                   boost::shared_ptr<TranslationJob> job,
                    System &system,
                    const std::string &line,
-                   long translationId)
+                   long translationId,
+                   double deadline)
   :TranslationTask(system, line, translationId)
-  ,m_cond(cond)
-  ,m_mutex(mut)
-  ,m_done(false)
+  ,m_job(job)
+  ,m_deadline(deadline)
+  ,m_errorCode(xmlrpc_c::fault::CODE_UNSPECIFIED)
 {
-
+  // per-request time budget, in ms
+  typedef std::map<std::string,xmlrpc_c::value> param_t;
+  param_t const& params = paramList.getStruct(0);
+  param_t::const_iterator si = params.find("cube-pruning-time-budget");
+  if (si != params.end()) {
+    m_mgr->SetTimeBudget(xmlrpc_c::value_int(si->second) / 1000.0);
+  }
 }
 
 boost::shared_ptr<TranslationRequest>
 TranslationRequest::
 create(Translator* translator,
        xmlrpc_c::paramList const& paramList,
-       boost::condition_variable& cond,
-       boost::mutex& mut,
+       boost::shared_ptr<TranslationJob> job,
        System &system,
        const std::string &line,
-       long translationId)
+       long translationId,
+       double deadline)
 {
   boost::shared_ptr<TranslationRequest> ret;
-  TranslationRequest *request = new TranslationRequest(paramList, cond, mut, system, line, translationId);
+  TranslationRequest *request = new TranslationRequest(paramList, job, system, line, translationId, deadline);
   ret.reset(request);
   ret->m_translator = translator;
   return ret;
@@ -43,19 +50,44 @@ void
 TranslationRequest::
 Run()
 {
-  m_mgr->Decode();
+  // the job waits for every task, so this must finish it whatever
+  // happens here
+  try {
+    if (m_deadline > 0) {
+      // whatever time is left becomes the search's time limit
+      double left = m_deadline - util::WallTime();
+      if (left <= 0) {
+        throw xmlrpc_c::fault("Request timed out before decoding started",
+                              xmlrpc_c::fault::CODE_TIMEOUT);
+      }
+      m_mgr->SetTimeLimit(left);
+    }
 
-  string out;
-  out = m_mgr->OutputBest();
-  m_retData["text"] = xmlrpc_c::value_string(out);
+    m_mgr->Decode();
 
-  {
-    boost::lock_guard<boost::mutex> lock(m_mutex);
-    m_done = true;
+    string out;
+    out = m_mgr->OutputBest();
+    m_retData["text"] = xmlrpc_c::value_string(out);
+    if (m_mgr->GetDegradation() > 0) {
+      m_retData["degradation"] = xmlrpc_c::value_double(m_mgr->GetDegradation());
+    }
+    if (m_deadline > 0 && util::WallTime() >= m_deadline) {
+      m_retData["timed-out"] = xmlrpc_c::value_boolean(true);
+    }
+  } catch (const xmlrpc_c::fault &e) {
+    m_error = e.getDescription();
+    m_errorCode = e.getCode();
+  } catch (const std::exception &e) {
+    m_error = e.what();
+    m_errorCode = xmlrpc_c::fault::CODE_INTERNAL;
   }
-  m_cond.notify_one();
 
   delete m_mgr;
+
+  // the job holds this task, so don't keep the job alive in turn
+  boost::shared_ptr<TranslationJob> job;
+  job.swap(m_job);
+  job->Finished();
 }
 
 void TranslationRequest::pack_hypothesis(const Manager& manager, Hypothesis const* h,
@@ -28,16 +28,17 @@ protected:
   std::map<std::string, xmlrpc_c::value> m_retData;
   Translator* m_translator;
 
-  boost::condition_variable& m_cond;
-  boost::mutex& m_mutex;
-  bool m_done;
+  boost::shared_ptr<TranslationJob> m_job; // until Run() has finished
+  double m_deadline; // wall time by which the reply is due, 0 = none
+  std::string m_error; // why the request failed, empty if it didn't
+  xmlrpc_c::fault::code_t m_errorCode;
 
   TranslationRequest(xmlrpc_c::paramList const& paramList,
-                     boost::condition_variable& cond,
-                     boost::mutex& mut,
+                     boost::shared_ptr<TranslationJob> job,
                      System &system,
                      const std::string &line,
-                     long translationId);
+                     long translationId,
+                     double deadline);
 
   void
   pack_hypothesis(const Manager& manager, Hypothesis const* h,
@@ -50,11 +51,11 @@ public:
   boost::shared_ptr<TranslationRequest>
   create(Translator* translator,
          xmlrpc_c::paramList const& paramList,
-         boost::condition_variable& cond,
-         boost::mutex& mut,
+         boost::shared_ptr<TranslationJob> job,
          System &system,
          const std::string &line,
-         long translationId);
+         long translationId,
+         double deadline = 0);
 
 
   virtual bool
@@ -62,16 +63,19 @@ public:
     return false;
   }
 
-  bool
-  IsDone() const {
-    return m_done;
-  }
-
   std::map<std::string, xmlrpc_c::value> const&
-  GetRetData() {
+  GetRetData() const {
     return m_retData;
   }
 
+  const std::string &GetError() const {
+    return m_error;
+  }
+
+  xmlrpc_c::fault::code_t GetErrorCode() const {
+    return m_errorCode;
+  }
+
   void
   Run();
 
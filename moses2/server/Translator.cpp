@@ -4,11 +4,14 @@
  *  Created on: 1 Apr 2016
  *      Author: hieu
  */
+#include <sstream>
 #include <boost/shared_ptr.hpp>
 #include "Translator.h"
 #include "TranslationRequest.h"
 #include "Server.h"
 #include "../parameters/ServerOptions.h"
+#include "../legacy/Util2.h"
+#include "util/usage.hh"
 
 using namespace std;
 
@@ -17,15 +20,17 @@ namespace Moses2
 
 Translator::Translator(Server& server, System &system)
   : m_server(server),
-    m_threadPool(server.options().numThreads),
+    m_scheduler(server.scheduler()),
     m_system(system),
-    m_translationId(0)
+    m_translationId(0),
+    m_numAdmitted(0)
 {
   // signature and help strings are documentation -- the client
   // can query this information with a system.methodSignature and
   // system.methodHelp RPC.
   this->_signature = "S:S";
-  this->_help = "Does translation";
+  this->_help = "Does translation. Give an array of sentences as 'text' "
+                "to translate them as a batch";
 }
 
 Translator::~Translator()
@@ -33,6 +38,107 @@ Translator::~Translator()
   // TODO Auto-generated destructor stub
 }
 
+void Translator::Admit(size_t n)
+{
+  size_t limit = m_server.options().maxQueue;
+  boost::lock_guard<boost::mutex> lock(m_admissionLock);
+  if (limit && m_numAdmitted + n > limit) {
+    stringstream msg;
+    msg << "Server busy: " << m_numAdmitted << " sentences queued, limit is "
+        << limit;
+    throw xmlrpc_c::fault(msg.str(), xmlrpc_c::fault::CODE_LIMIT_EXCEEDED);
+  }
+  m_numAdmitted += n;
+}
+
+void Translator::Release(size_t n)
+{
+  boost::lock_guard<boost::mutex> lock(m_admissionLock);
+  m_numAdmitted -= n;
+}
+
+TranslationJob::TranslationJob(Translator &translator, size_t size, bool batch)
+  :m_translator(translator)
+  ,m_size(size)
+  ,m_batch(batch)
+  ,m_pending(size)
+  ,m_finishTime(0)
+{
+  m_translator.Admit(m_size);
+}
+
+TranslationJob::~TranslationJob()
+{
+  // tasks that were never created can't finish the job
+  if (m_pending) {
+    m_translator.Release(m_size);
+  }
+}
+
+void TranslationJob::Finished()
+{
+  bool done;
+  {
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    done = (--m_pending == 0);
+    if (done) {
+      m_finishTime = util::WallTime();
+    }
+  }
+  if (done) {
+    m_translator.Release(m_size);
+    m_cond.notify_all();
+  }
+}
+
+bool TranslationJob::IsDone()
+{
+  boost::lock_guard<boost::mutex> lock(m_lock);
+  return m_pending == 0;
+}
+
+void TranslationJob::Wait()
+{
+  boost::unique_lock<boost::mutex> lock(m_lock);
+  while (m_pending) {
+    m_cond.wait(lock);
+  }
+}
+
+double TranslationJob::GetFinishTime()
+{
+  boost::lock_guard<boost::mutex> lock(m_lock);
+  return m_finishTime;
+}
+
+void TranslationJob::Reply(xmlrpc_c::value *const retvalP) const
+{
+  typedef std::map<std::string,xmlrpc_c::value> param_t;
+  if (!m_batch) {
+    const TranslationRequest &task = *tasks[0];
+    if (task.GetError().size()) {
+      throw xmlrpc_c::fault(task.GetError(), task.GetErrorCode());
+    }
+    *retvalP = xmlrpc_c::value_struct(task.GetRetData());
+    return;
+  }
+
+  // a failed sentence doesn't fail the batch, it reports its error instead
+  vector<xmlrpc_c::value> translations(tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (tasks[i]->GetError().size()) {
+      param_t err;
+      err["error"] = xmlrpc_c::value_string(tasks[i]->GetError());
+      translations[i] = xmlrpc_c::value_struct(err);
+    } else {
+      translations[i] = xmlrpc_c::value_struct(tasks[i]->GetRetData());
+    }
+  }
+  param_t ret;
+  ret["translations"] = xmlrpc_c::value_array(translations);
+  *retvalP = xmlrpc_c::value_struct(ret);
+}
+
 void Translator::execute(xmlrpc_c::paramList const& paramList,
                          xmlrpc_c::value *const  retvalP)
 {
@@ -44,25 +150,171 @@ void Translator::execute(xmlrpc_c::paramList const& paramList,
     throw xmlrpc_c::fault("Missing source text", xmlrpc_c::fault::CODE_PARSE);
   }
 
-  string line = xmlrpc_c::value_string(si->second);
+  bool batch = si->second.type() == xmlrpc_c::value::TYPE_ARRAY;
+  vector<string> lines;
+  if (batch) {
+    vector<xmlrpc_c::value> texts = xmlrpc_c::value_array(si->second).vectorValueValue();
+    for (size_t i = 0; i < texts.size(); ++i) {
+      lines.push_back(xmlrpc_c::value_string(texts[i]));
+    }
+  } else {
+    lines.push_back(xmlrpc_c::value_string(si->second));
+  }
+
+  Scheduler::Priority priority = batch ? Scheduler::Bulk : Scheduler::Interactive;
+  si = params.find("priority");
+  if (si != params.end()
+      && !Scheduler::ParsePriority(xmlrpc_c::value_string(si->second), priority)) {
+    throw xmlrpc_c::fault("Unknown priority, must be interactive or bulk",
+                          xmlrpc_c::fault::CODE_PARSE);
+  }
+  string clientId;
+  si = params.find("client-id");
+  if (si != params.end()) {
+    clientId = xmlrpc_c::value_string(si->second);
+  }
+
+  bool async = false;
+  si = params.find("async");
+  if (si != params.end()) {
+    async = xmlrpc_c::value_boolean(si->second);
+  }
+
+  // clients may ask for less time than the server allows. All parameters
+  // are checked before the job is admitted, so a bad one can't hold a
+  // place in the queue
+  double timeout = m_server.options().requestTimeout;
+  si = params.find("timeout");
+  if (si != params.end()) {
+    double t;
+    if (si->second.type() == xmlrpc_c::value::TYPE_INT) {
+      t = xmlrpc_c::value_int(si->second);
+    } else if (si->second.type() == xmlrpc_c::value::TYPE_DOUBLE) {
+      t = xmlrpc_c::value_double(si->second);
+    } else {
+      throw xmlrpc_c::fault("timeout must be a number of seconds",
+                            xmlrpc_c::fault::CODE_PARSE);
+    }
+    if (t > 0 && (timeout <= 0 || t < timeout)) {
+      timeout = t;
+    }
+  }
+
+  boost::shared_ptr<TranslationJob> job(new TranslationJob(*this, lines.size(), batch));
+
+  // the request timeout counts from admission, so it includes the wait
+  // in the queue
+  double deadline = timeout > 0 ? util::WallTime() + timeout : 0;
+
+
   long translationId;
 
-  // get unique id. Thread safe
+  // get unique ids. Thread safe
   {
     boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
-    translationId = m_translationId++;
+    translationId = m_translationId;
+    m_translationId += lines.size();
   }
 
-  boost::condition_variable cond;
-  boost::mutex mut;
-  boost::shared_ptr<TranslationRequest> task;
-  task = TranslationRequest::create(this, paramList,cond,mut, m_system, line, translationId);
-  m_threadPool.Submit(task);
-  boost::unique_lock<boost::mutex> lock(mut);
-  while (!task->IsDone()) {
-    cond.wait(lock);
+  size_t submitted = 0;
+  try {
+    job->tasks.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+      job->tasks[i] = TranslationRequest::create(this, paramList, job, m_system,
+                      lines[i], translationId + i, deadline);
+    }
+    for (; submitted < lines.size(); ++submitted) {
+      m_scheduler.Submit(job->tasks[submitted], clientId, priority,
+                         Tokenize(lines[submitted]).size());
+    }
+  } catch (...) {
+    // the tasks already queued still run and finish the job, the others
+    // never will. Dropping them also drops their hold on the job
+    job->tasks.resize(submitted);
+    for (size_t i = submitted; i < lines.size(); ++i) {
+      job->Finished();
+    }
+    throw;
+  }
+
+  if (async) {
+    DropExpiredJobs();
+    {
+      boost::lock_guard<boost::mutex> lock(m_jobsLock);
+      m_jobs[translationId] = job;
+    }
+    param_t ret;
+    ret["job-id"] = xmlrpc_c::value_int(translationId);
+    *retvalP = xmlrpc_c::value_struct(ret);
+    return;
+  }
+
+  job->Wait();
+  job->Reply(retvalP);
+}
+
+void Translator::Collect(long jobId, xmlrpc_c::value *const retvalP)
+{
+  DropExpiredJobs();
+
+  boost::shared_ptr<TranslationJob> job;
+  {
+    boost::lock_guard<boost::mutex> lock(m_jobsLock);
+    std::map<long, boost::shared_ptr<TranslationJob> >::iterator iter = m_jobs.find(jobId);
+    if (iter == m_jobs.end()) {
+      throw xmlrpc_c::fault("Unknown job id, or its result has already been collected or dropped",
+                            xmlrpc_c::fault::CODE_INDEX);
+    }
+    if (!iter->second->IsDone()) {
+      std::map<std::string,xmlrpc_c::value> ret;
+      ret["job-id"] = xmlrpc_c::value_int(jobId);
+      ret["pending"] = xmlrpc_c::value_boolean(true);
+      *retvalP = xmlrpc_c::value_struct(ret);
+      return;
+    }
+    job = iter->second;
+    m_jobs.erase(iter);
+  }
+  job->Reply(retvalP);
+}
+
+void Translator::DropExpiredJobs()
+{
+  double expiry = m_server.options().resultTimeout;
+  if (expiry <= 0) {
+    return;
+  }
+  double now = util::WallTime();
+  boost::lock_guard<boost::mutex> lock(m_jobsLock);
+  std::map<long, boost::shared_ptr<TranslationJob> >::iterator iter = m_jobs.begin();
+  while (iter != m_jobs.end()) {
+    double finished = iter->second->GetFinishTime();
+    if (finished > 0 && now - finished > expiry) {
+      m_jobs.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+TranslationResult::TranslationResult(Translator &translator)
+  :m_translator(translator)
+{
+  this->_signature = "S:S";
+  this->_help = "Returns the result of an async translate call, given its "
+                "'job-id', or 'pending' if it isn't finished";
+}
+
+void TranslationResult::execute(xmlrpc_c::paramList const& paramList,
+                                xmlrpc_c::value *const retvalP)
+{
+  typedef std::map<std::string,xmlrpc_c::value> param_t;
+  param_t const& params = paramList.getStruct(0);
+  param_t::const_iterator si = params.find("job-id");
+  if (si == params.end()) {
+    throw xmlrpc_c::fault("Missing job id", xmlrpc_c::fault::CODE_PARSE);
   }
-  *retvalP = xmlrpc_c::value_struct(task->GetRetData());
+  m_translator.Collect(xmlrpc_c::value_int(si->second), retvalP);
 }
 
 } /* namespace Moses2 */
@@ -6,17 +6,59 @@
  */
 
 #pragma once
+#include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <xmlrpc-c/base.hpp>
 #include <xmlrpc-c/registry.hpp>
 #include <xmlrpc-c/server_abyss.hpp>
-#include "../legacy/ThreadPool.h"
 
 namespace Moses2
 {
 class Server;
+class Scheduler;
 class System;
 class Manager;
+class Translator;
+class TranslationRequest;
+
+// The sentences of one request. Each task holds the job until it has
+// finished, so the job outlives the call that made it, even if that call
+// threw or returned at once. Keeps its sentences admitted until the last
+// of them is done.
+class TranslationJob
+{
+public:
+  TranslationJob(Translator &translator, size_t size, bool batch);
+  ~TranslationJob();
+
+  std::vector<boost::shared_ptr<TranslationRequest> > tasks;
+
+  // a task has finished, or will never run
+  void Finished();
+
+  bool IsDone();
+  void Wait();
+
+  // wall time at which the last task finished, 0 while any are left
+  double GetFinishTime();
+
+  // the reply for a finished job. A single sentence's error is thrown as
+  // a fault, a batch reports errors per sentence
+  void Reply(xmlrpc_c::value *const retvalP) const;
+
+protected:
+  Translator &m_translator;
+  size_t m_size;
+  bool m_batch;
+  size_t m_pending;
+  double m_finishTime;
+  boost::mutex m_lock;
+  boost::condition_variable m_cond;
+};
 
 class Translator : public xmlrpc_c::method
 {
@@ -24,17 +66,56 @@ public:
   Translator(Server& server, System &system);
   virtual ~Translator();
 
+  // A request whose "text" is an array of sentences is a batch: the
+  // sentences are decoded side by side on the thread pool and the
+  // results come back in the same order under "translations".
+  // "client-id" and "priority" (interactive or bulk; batches default to
+  // bulk) tell the scheduler whose sentences these are.
+  // With "async" set the call returns a "job-id" at once, without waiting
+  // for the translation; the reply is fetched with translate_result.
   void execute(xmlrpc_c::paramList const& paramList,
                xmlrpc_c::value *   const  retvalP);
 
+  // the reply of an async job, or "pending" if it isn't finished
+  void Collect(long jobId, xmlrpc_c::value *const retvalP);
+
 protected:
+  friend class TranslationJob;
+
   Server& m_server;
-  Moses2::ThreadPool m_threadPool;
+  Scheduler &m_scheduler;
   System &m_system;
   long m_translationId;
   boost::shared_mutex m_accessLock;
 
+  // sentences queued or being decoded. Requests that would take this above
+  // server-max-queue are turned away at once rather than left waiting
+  // on a connection thread
+  boost::mutex m_admissionLock;
+  size_t m_numAdmitted;
+
+  void Admit(size_t n);
+  void Release(size_t n);
+
+  // async jobs by id, until their reply is collected. Replies nobody
+  // collects are dropped server-result-timeout seconds after they finished
+  boost::mutex m_jobsLock;
+  std::map<long, boost::shared_ptr<TranslationJob> > m_jobs;
+
+  void DropExpiredJobs();
 };
 
-} /* namespace Moses2 */
+// translate_result: takes the "job-id" that an async translate returned
+class TranslationResult : public xmlrpc_c::method
+{
+public:
+  TranslationResult(Translator &translator);
 
+  void execute(xmlrpc_c::paramList const& paramList,
+               xmlrpc_c::value *   const  retvalP);
+
+protected:
+  Translator &m_translator;
+};
+
+} /* namespace Moses2 */
@@ -0,0 +1,2 @@
+#!/bin/sh
+./bjam -j2 --without-tcmalloc moses//moses_test lm util misc//benchmarkRuleTableLoad lm/builder//lmplz
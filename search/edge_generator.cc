@@ -112,5 +112,7 @@ template PartialEdge EdgeGenerator::Pop(Context<lm::ngram::TrieModel> &context);
 template PartialEdge EdgeGenerator::Pop(Context<lm::ngram::QuantTrieModel> &context);
 template PartialEdge EdgeGenerator::Pop(Context<lm::ngram::ArrayTrieModel> &context);
 template PartialEdge EdgeGenerator::Pop(Context<lm::ngram::QuantArrayTrieModel> &context);
+template PartialEdge EdgeGenerator::Pop(Context<lm::ngram::EliasFanoTrieModel> &context);
+template PartialEdge EdgeGenerator::Pop(Context<lm::ngram::QuantEliasFanoTrieModel> &context);
 
 } // namespace search
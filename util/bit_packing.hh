@@ -153,6 +153,27 @@ void BitPackingSanity();
 // efficient implementation, but this is only called a few times to size tries.
 uint8_t RequiredBits(uint64_t max_value);
 
+// Number of set bits.
+inline unsigned int PopCount64(uint64_t value) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(value);
+#else
+  value -= (value >> 1) & 0x5555555555555555ULL;
+  value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+  value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<unsigned int>((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Position of the lowest set bit.  value must not be zero.
+inline unsigned int LowestBit64(uint64_t value) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(value);
+#else
+  return PopCount64((value & (~value + 1)) - 1);
+#endif
+}
+
 struct BitsMask {
   static BitsMask ByMax(uint64_t max_value) {
     BitsMask ret;
@@ -137,7 +137,9 @@ typedef enum {
   POPULATE_OR_READ,
   // malloc and read.
   READ,
-  // malloc and read in parallel (recommended for Lustre)
+  // malloc and read in parallel (recommended for Lustre).  Like READ, the
+  // memory comes from HugeMalloc: reserved hugetlb pages if there are
+  // enough, otherwise transparent huge pages where the kernel allows them.
   PARALLEL_READ,
 } LoadMethod;
 
@@ -0,0 +1,114 @@
+#include "util/numa.hh"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+namespace util {
+
+namespace {
+
+// Largest number in a kernel list like "0-3,8-11".  -1 if empty.
+int ListMax(const std::string &list) {
+  int ret = -1;
+  std::istringstream in(list);
+  std::string range;
+  while (std::getline(in, range, ',')) {
+    std::string::size_type dash = range.find('-');
+    int last = atoi(range.substr(dash == std::string::npos ? 0 : dash + 1).c_str());
+    if (last > ret) ret = last;
+  }
+  return ret;
+}
+
+// Every number in a kernel list like "0-3,8-11".
+std::vector<int> ListMembers(const std::string &list) {
+  std::vector<int> ret;
+  std::istringstream in(list);
+  std::string range;
+  while (std::getline(in, range, ',')) {
+    if (range.empty()) continue;
+    std::string::size_type dash = range.find('-');
+    int first = atoi(range.c_str());
+    int last = dash == std::string::npos ? first : atoi(range.substr(dash + 1).c_str());
+    for (int i = first; i <= last; ++i) ret.push_back(i);
+  }
+  return ret;
+}
+
+std::string ReadLine(const std::string &name) {
+  std::ifstream in(name.c_str());
+  std::string ret;
+  std::getline(in, ret);
+  return ret;
+}
+
+std::size_t ReadNodeCount() {
+  int last = ListMax(ReadLine("/sys/devices/system/node/online"));
+  return last < 0 ? 1 : last + 1;
+}
+
+// Node of each CPU.
+std::vector<std::size_t> ReadCPUNodes() {
+  std::vector<std::size_t> ret;
+  for (std::size_t node = 0; node < NUMANodeCount(); ++node) {
+    std::ostringstream name;
+    name << "/sys/devices/system/node/node" << node << "/cpulist";
+    std::vector<int> cpus(ListMembers(ReadLine(name.str())));
+    for (std::size_t i = 0; i < cpus.size(); ++i) {
+      if (ret.size() <= (std::size_t)cpus[i]) ret.resize(cpus[i] + 1, 0);
+      ret[cpus[i]] = node;
+    }
+  }
+  return ret;
+}
+
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+// From linux/mempolicy.h, which isn't always installed.
+const int kPolicyDefault = 0;
+const int kPolicyPreferred = 1;
+const std::size_t kMaxNodes = 1024;
+#endif
+
+} // namespace
+
+std::size_t NUMANodeCount() {
+  static const std::size_t count = ReadNodeCount();
+  return count;
+}
+
+std::size_t CurrentNUMANode() {
+#ifdef __linux__
+  static const std::vector<std::size_t> cpu_nodes(ReadCPUNodes());
+  int cpu = sched_getcpu();
+  if (cpu >= 0 && (std::size_t)cpu < cpu_nodes.size()) return cpu_nodes[cpu];
+#endif
+  return 0;
+}
+
+NUMABindScope::NUMABindScope(std::size_t node) : bound_(false) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  if (NUMANodeCount() < 2 || node >= kMaxNodes) return;
+  const std::size_t kBits = 8 * sizeof(unsigned long);
+  unsigned long mask[kMaxNodes / kBits] = {0};
+  mask[node / kBits] = 1UL << (node % kBits);
+  // Preferred rather than bind: a full node spills over instead of failing.
+  bound_ = !syscall(SYS_set_mempolicy, kPolicyPreferred, mask, kMaxNodes + 1);
+#endif
+}
+
+NUMABindScope::~NUMABindScope() {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  if (bound_) syscall(SYS_set_mempolicy, kPolicyDefault, NULL, 0);
+#endif
+}
+
+} // namespace util
@@ -0,0 +1,40 @@
+#ifndef UTIL_NUMA_H
+#define UTIL_NUMA_H
+/* Placing memory on NUMA nodes, so that a model can be loaded once per node
+ * and every thread queries the copy in its local memory.  Uses the system
+ * calls directly rather than libnuma.  On non-Linux systems there is one
+ * node and binding does nothing.
+ */
+
+#include <cstddef>
+
+namespace util {
+
+// Number of NUMA nodes with memory.  1 if unknown.
+std::size_t NUMANodeCount();
+
+// Node of the CPU the calling thread is running on.  Cheap enough to call
+// for every query.  0 if unknown.
+std::size_t CurrentNUMANode();
+
+/* While in scope, memory that the calling thread (and threads it starts)
+ * touches for the first time is placed on the given node, as long as the
+ * node has memory free.  Load a model inside the scope with a load method
+ * that copies the file, e.g. READ or PARALLEL_READ; mmapped files stay in the
+ * shared page cache.
+ */
+class NUMABindScope {
+  public:
+    explicit NUMABindScope(std::size_t node);
+    ~NUMABindScope();
+
+  private:
+    bool bound_;
+
+    NUMABindScope(const NUMABindScope &);
+    NUMABindScope &operator=(const NUMABindScope &);
+};
+
+} // namespace util
+
+#endif // UTIL_NUMA_H
@@ -217,6 +217,13 @@ template <class EntryT, class HashT, class EqualT = std::equal_to<typename Entry
       }
     }
 
+    // Hint that key will be looked up soon so the ideal bucket is in cache.
+    template <class Key> void Prefetch(const Key key) const {
+#if defined(__GNUC__)
+      __builtin_prefetch(Ideal(key));
+#endif
+    }
+
     void Clear() {
       Entry invalid;
       invalid.SetKey(invalid_);